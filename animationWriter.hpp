@@ -0,0 +1,202 @@
+#ifndef _ANIMATION_WRITER
+#define _ANIMATION_WRITER
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <mutex>
+
+#include <opencv2/opencv.hpp>
+
+#include "paletteQuantizer.hpp"
+#include "gifEncoder.hpp"
+
+enum class AnimationFormat {
+    GIF,        // GifEncoder. 256 색 팔레트, 바뀐 사각형만 기록
+    VIDEO       // cv::VideoWriter. 로컬 OpenCV 빌드가 지원하는 코덱/컨테이너
+};
+
+// VIDEO 설정. 컨테이너는 파일 확장자로 정해진다
+struct VideoCodec {
+    std::string fourcc = "MJPG";
+    std::string extension = ".avi";
+    int keyframe_interval = 0;      // 0 이면 코덱 기본값. FFmpeg backend 에서만 적용된다 (MJPG 는 모든 프레임이 키프레임)
+};
+
+// Animation frame writer.
+// 렌더링된 BGR 프레임을 순서대로 받아 GIF 또는 비디오 파일로 바로 인코딩한다. 프레임을 모아 두지 않는다
+class AnimationWriter {
+public:
+    AnimationWriter() = default;
+
+    ~AnimationWriter()
+    {
+        close();
+    }
+
+    AnimationWriter(const AnimationWriter&) = delete;
+    AnimationWriter& operator=(const AnimationWriter&) = delete;
+
+    // base_filename 에 형식에 맞는 확장자를 붙인 이름
+    static std::string filename_for(const std::string& base_filename, AnimationFormat format, const VideoCodec& codec = VideoCodec())
+    {
+        return base_filename + (format == AnimationFormat::GIF ? ".gif" : codec.extension);
+    }
+
+    // quantizer 는 GIF 에만 쓰인다
+    bool open(const std::string& base_filename,
+              AnimationFormat format,
+              const cv::Size& frame_size,
+              double fps = 10,
+              const VideoCodec& codec = VideoCodec(),
+              const PaletteQuantizer& quantizer = PaletteQuantizer::fixed())
+    {
+        close();
+        this->format = format;
+        filename = filename_for(base_filename, format, codec);
+        fps = fps > 0 ? fps : 10;
+
+        if (format == AnimationFormat::GIF)
+        {
+            // GIF 지연은 1/100 초 단위
+            int delay = std::max(1, static_cast<int>(std::lround(100.0 / fps)));
+            return gif.open(filename, frame_size.width, frame_size.height, delay, quantizer);
+        }
+
+        if (codec.fourcc.size() != 4)
+        {
+            std::cerr << "Invalid video fourcc: " << codec.fourcc << std::endl;
+            return false;
+        }
+        int fourcc = cv::VideoWriter::fourcc(codec.fourcc[0], codec.fourcc[1], codec.fourcc[2], codec.fourcc[3]);
+        bool opened = false;
+        try {
+            // VideoWriter 의 params 에는 인코더 GOP 길이 항목이 없어서 환경 변수로 넘긴다.
+            // 환경 변수는 프로세스 전체가 공유하므로 바꾸고 되돌리는 동안 다른 writer 는 open 하지 못하게 한다
+            std::lock_guard<std::mutex> lock(env_mutex);
+            if (codec.keyframe_interval > 0)
+            {
+                // FFmpeg backend 는 open 할 때 OPENCV_FFMPEG_WRITER_OPTIONS ("key;value|...") 를 읽는다. g 는 GOP 길이
+                ScopedWriterOptions options("g;" + std::to_string(codec.keyframe_interval));
+                opened = video.open(filename, fourcc, fps, frame_size, true);
+            }
+            else
+            {
+                opened = video.open(filename, fourcc, fps, frame_size, true);
+            }
+        } catch (const cv::Exception& e) {
+            std::cerr << "Error opening video: " << e.what() << std::endl;
+            opened = false;
+        }
+        if (!opened || !video.isOpened())
+        {
+            std::cerr << "Can't open video: " << filename << " (" << codec.fourcc << ")" << std::endl;
+            return false;
+        }
+        video_size = frame_size;
+        video_frames = 0;
+        return true;
+    }
+
+    // BGR 8UC3 프레임. 크기는 open() 때와 같아야 한다
+    bool add_frame(const cv::Mat& frame)
+    {
+        if (format == AnimationFormat::GIF)
+            return gif.add_frame(frame);
+
+        if (!video.isOpened())
+            return false;
+        if (frame.type() != CV_8UC3 || frame.cols != video_size.width || frame.rows != video_size.height)
+        {
+            std::cerr << "Video frame must be a " << video_size.width << "x" << video_size.height << " BGR image" << std::endl;
+            return false;
+        }
+        video.write(frame);
+        video_frames++;
+        return true;
+    }
+
+    bool close()
+    {
+        bool ok = gif.close();
+        if (video.isOpened())
+        {
+            video.release();
+        }
+        return ok;
+    }
+
+    bool is_open() const
+    {
+        return format == AnimationFormat::GIF ? gif.is_open() : video.isOpened();
+    }
+
+    const std::string& file_name() const { return filename; }
+
+    // add_frame() 으로 받은 프레임 수
+    int frame_count() const
+    {
+        return format == AnimationFormat::GIF ? gif.frame_count() : video_frames;
+    }
+
+private:
+    static constexpr const char* WRITER_OPTIONS = "OPENCV_FFMPEG_WRITER_OPTIONS";
+    inline static std::mutex env_mutex;
+
+    // options 를 기존 WRITER_OPTIONS 앞에 붙이고, 소멸할 때 (open 이 예외를 던져도) 원래 값으로 되돌린다.
+    // env_mutex 를 잡은 채로 써야 한다
+    class ScopedWriterOptions {
+    public:
+        explicit ScopedWriterOptions(const std::string& options)
+        {
+            const char* previous = std::getenv(WRITER_OPTIONS);
+            had_previous = previous != nullptr;
+            saved = previous ? previous : "";
+            set_env(WRITER_OPTIONS, saved.empty() ? options : options + "|" + saved);
+        }
+
+        ~ScopedWriterOptions()
+        {
+            if (had_previous)
+                set_env(WRITER_OPTIONS, saved);
+            else
+                unset_env(WRITER_OPTIONS);
+        }
+
+        ScopedWriterOptions(const ScopedWriterOptions&) = delete;
+        ScopedWriterOptions& operator=(const ScopedWriterOptions&) = delete;
+
+    private:
+        bool had_previous;
+        std::string saved;
+    };
+
+    AnimationFormat format = AnimationFormat::GIF;
+    std::string filename;
+    GifEncoder gif;
+    cv::VideoWriter video;
+    cv::Size video_size;
+    int video_frames = 0;
+
+    static void set_env(const char* name, const std::string& value)
+    {
+#ifndef _WIN32
+        setenv(name, value.c_str(), 1);
+#else
+        _putenv_s(name, value.c_str());
+#endif
+    }
+
+    static void unset_env(const char* name)
+    {
+#ifndef _WIN32
+        unsetenv(name);
+#else
+        _putenv_s(name, "");
+#endif
+    }
+};
+
+#endif
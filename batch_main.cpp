@@ -0,0 +1,320 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <exception>
+#include <charconv>
+
+#include "stackingCore.hpp"
+#include "jsonUtils.hpp"
+#include "threadPool.hpp"
+
+// 주문 디렉토리(또는 주문 파일 목록)를 병렬로 계획하는 배치 실행기
+//
+// usage: batch_main <orders_dir | manifest.txt> <output_dir>
+//                   [--method layered|optimized|stack_all|buffer|stack_with_buffer]
+//                   [--pallet W L H] [--gap N] [--threads N] [--format json|ndjson|binary]
+//
+// 주문 파일은 JSON 박스 목록(.json) 또는 BoxSetFile(.bin). 결과는 output_dir/<주문 이름>_result.<ext>
+
+namespace {
+
+struct BatchOptions {
+    std::filesystem::path input;
+    std::filesystem::path output_dir;
+    StackingMethod method = StackingMethod::LAYERED;
+    std::vector<int> pallet_size = {1100, 1100, 1800};
+    int gap = 5;
+    size_t threads = std::thread::hardware_concurrency();
+    ResultFormat format = ResultFormat::JSON;
+};
+
+bool parse_format(const std::string& name, ResultFormat& format)
+{
+    if (name == "json") format = ResultFormat::JSON;
+    else if (name == "ndjson") format = ResultFormat::NDJSON;
+    else if (name == "binary") format = ResultFormat::BINARY;
+    else return false;
+    return true;
+}
+
+std::string result_extension(ResultFormat format)
+{
+    switch (format)
+    {
+        case ResultFormat::NDJSON: return ".ndjson";
+        case ResultFormat::BINARY: return ".bin";
+        default: return ".json";
+    }
+}
+
+// 정수 전체가 숫자여야 한다 ("5mm" 같은 값은 거부)
+bool parse_int(const std::string& text, int& value)
+{
+    const char* last = text.data() + text.size();
+    auto parsed = std::from_chars(text.data(), last, value);
+    return parsed.ec == std::errc() && parsed.ptr == last;
+}
+
+bool parse_args(int argc, char** argv, BatchOptions& options)
+{
+    if (argc < 3)
+        return false;
+    options.input = argv[1];
+    options.output_dir = argv[2];
+
+    try {
+        for (int i = 3; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--method" && i + 1 < argc)
+            {
+                if (!parse_stacking_method(argv[++i], options.method))
+                    return false;
+            }
+            else if (arg == "--pallet" && i + 3 < argc)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    if (!parse_int(argv[++i], options.pallet_size[axis]))
+                    {
+                        std::cerr << "Invalid pallet size: " << argv[i] << std::endl;
+                        return false;
+                    }
+                }
+            }
+            else if (arg == "--gap" && i + 1 < argc)
+            {
+                if (!parse_int(argv[++i], options.gap))
+                {
+                    std::cerr << "Invalid gap: " << argv[i] << std::endl;
+                    return false;
+                }
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                int threads = 0;
+                if (!parse_int(argv[++i], threads) || threads < 1)
+                {
+                    std::cerr << "Invalid thread count: " << argv[i] << std::endl;
+                    return false;
+                }
+                options.threads = static_cast<size_t>(threads);
+            }
+            else if (arg == "--format" && i + 1 < argc)
+            {
+                if (!parse_format(argv[++i], options.format))
+                    return false;
+            }
+            else
+            {
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid argument: " << e.what() << std::endl;
+        return false;
+    }
+
+    // 간격이 0 이하이면 배치 탐색이 끝나지 않는다
+    if (!StackingAlgorithm::valid_setup(options.pallet_size, options.gap))
+    {
+        std::cerr << "Pallet dimensions and gap must be positive" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 디렉토리면 안의 .json/.bin 파일을, 파일이면 한 줄에 하나씩 적힌 주문 경로를 읽는다
+std::vector<std::filesystem::path> collect_orders(const std::filesystem::path& input)
+{
+    std::vector<std::filesystem::path> orders;
+    std::error_code ec;
+    if (std::filesystem::is_directory(input, ec))
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(input, ec))
+        {
+            auto ext = entry.path().extension();
+            if (entry.is_regular_file() && (ext == ".json" || ext == ".bin"))
+            {
+                orders.push_back(entry.path());
+            }
+        }
+        std::sort(orders.begin(), orders.end());
+    }
+    else
+    {
+        std::ifstream manifest(input);
+        if (!manifest.is_open())
+        {
+            std::cerr << "Can't open: " << input << std::endl;
+            return orders;
+        }
+        std::string line;
+        while (std::getline(manifest, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (!line.empty() && line[0] != '#')
+            {
+                std::filesystem::path order(line);
+                orders.push_back(order.is_relative() ? input.parent_path() / order : order);
+            }
+        }
+    }
+    return orders;
+}
+
+// 파일을 열 수 없거나 손상되었으면 false
+bool load_order(const std::filesystem::path& order, std::vector<BoxRecord>& records)
+{
+    if (order.extension() == ".bin")
+    {
+        BoxSetFile box_set(order.string());
+        records = box_set.to_records();
+        return box_set.is_open();
+    }
+    return JsonUtils::load_box_records(order.string(), records);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BatchOptions options;
+    if (!parse_args(argc, argv, options))
+    {
+        std::cerr << "usage: " << argv[0] << " <orders_dir | manifest.txt> <output_dir>\n"
+                  << "       [--method layered|optimized|stack_all|buffer|stack_with_buffer]\n"
+                  << "       [--pallet W L H] [--gap N] [--threads N] [--format json|ndjson|binary]" << std::endl;
+        return 1;
+    }
+
+    try {
+        std::filesystem::create_directories(options.output_dir);
+    } catch (const std::filesystem::filesystem_error& e) {
+        std::cerr << "Error creating output directory: " << e.what() << std::endl;
+        return 1;
+    }
+
+    auto orders = collect_orders(options.input);
+    if (orders.empty())
+    {
+        std::cerr << "No orders found in " << options.input << std::endl;
+        return 1;
+    }
+
+    std::atomic<size_t> planned_orders{0};
+    std::atomic<size_t> failed_orders{0};
+    std::atomic<size_t> total_boxes{0};
+    std::atomic<size_t> placed_boxes{0};
+    // 주문별 지표. 주문마다 자기 칸에만 쓰므로 잠그지 않는다
+    std::vector<StackingMetrics> order_metrics(orders.size());
+    std::vector<char> order_planned(orders.size(), 0);
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(options.threads);
+        std::cout << "Planning " << orders.size() << " orders on " << pool.size() << " threads..." << std::endl;
+
+        for (size_t order_index = 0; order_index < orders.size(); order_index++)
+        {
+            pool.submit([&, order_index] {
+                // 예외가 pool 로 새면 주문이 성공도 실패도 아닌 채로 사라지므로 여기서 실패로 센다
+                try {
+                    const auto& order = orders[order_index];
+                    std::vector<BoxRecord> records;
+                    if (!load_order(order, records))
+                    {
+                        std::cerr << "Skipping unreadable order: " << order << std::endl;
+                        failed_orders++;
+                        return;
+                    }
+                    if (records.empty())
+                    {
+                        std::cerr << "Skipping empty order: " << order << std::endl;
+                        failed_orders++;
+                        return;
+                    }
+
+                    auto result_path = options.output_dir / (order.stem().string() + "_result" + result_extension(options.format));
+                    ResultWriter writer(result_path.string(), options.format);
+                    if (!writer.is_open())
+                    {
+                        failed_orders++;
+                        return;
+                    }
+
+                    StackingAlgorithm algorithm(records, options.pallet_size, options.gap);
+                    // NDJSON 은 배치가 결정되는 대로 흘려 보내고, 나머지 형식은 최종 배치만 쓴다
+                    if (options.format == ResultFormat::NDJSON)
+                    {
+                        algorithm.set_result_sink(writer.sink());
+                    }
+                    auto results = algorithm.Stack(options.method);
+                    if (options.format != ResultFormat::NDJSON)
+                    {
+                        writer.write_all(results);
+                    }
+                    if (!writer.close())
+                    {
+                        failed_orders++;
+                        return;
+                    }
+
+                    order_metrics[order_index] = StackingEvaluator::evaluate(results, records, options.pallet_size);
+                    order_planned[order_index] = 1;
+
+                    total_boxes += records.size();
+                    placed_boxes += static_cast<size_t>(order_metrics[order_index].main_count);
+                    planned_orders++;
+                } catch (const std::exception& e) {
+                    std::cerr << "Order failed: " << orders[order_index] << ": " << e.what() << std::endl;
+                    failed_orders++;
+                }
+            });
+        }
+        pool.wait_idle();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double fill_rate_sum = 0;
+    double fill_rate_min = 100;
+    double fill_rate_max = 0;
+    double max_height = 0;
+    for (size_t i = 0; i < orders.size(); i++)
+    {
+        if (!order_planned[i])
+            continue;
+        const auto& metrics = order_metrics[i];
+        fill_rate_sum += metrics.fill_rate;
+        fill_rate_min = std::min(fill_rate_min, metrics.fill_rate);
+        fill_rate_max = std::max(fill_rate_max, metrics.fill_rate);
+        max_height = std::max(max_height, metrics.max_height);
+    }
+
+    std::cout << "\nBatch Results:" << std::endl;
+    std::cout << "--------------------" << std::endl;
+    std::cout << "Orders planned: " << planned_orders << " (failed: " << failed_orders << ")" << std::endl;
+    std::cout << "Boxes: " << total_boxes << " (on main pallet: " << placed_boxes << ")" << std::endl;
+    if (planned_orders > 0)
+    {
+        std::cout << "Fill rate: mean " << fill_rate_sum / planned_orders << "%, min " << fill_rate_min
+                  << "%, max " << fill_rate_max << "%" << std::endl;
+        std::cout << "Max height: " << max_height << std::endl;
+    }
+    std::cout << "Elapsed: " << seconds << " s" << std::endl;
+    if (seconds > 0)
+    {
+        std::cout << "Throughput: " << planned_orders / seconds << " orders/s, "
+                  << total_boxes / seconds << " boxes/s" << std::endl;
+    }
+    std::cout << "--------------------" << std::endl;
+
+    return failed_orders == 0 ? 0 : 1;
+}
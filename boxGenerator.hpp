@@ -14,10 +14,12 @@
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <cstdint>
 
 #include <nlohmann/json.hpp>
 
 // Box generation utility
+// seed 를 주면 같은 박스 목록이 다시 만들어진다. 대량/병렬 생성은 workloadGenerator.hpp 참고
 class BoxGenerator {
 public:
     static std::vector<nlohmann::json> small_generate_boxes(
@@ -25,52 +27,39 @@ public:
         const std::pair<int, int>& x_range,
         const std::pair<int, int>& y_range,
         const std::pair<int, int>& z_range,
-        const std::vector<std::tuple<int, int, int>>& sizes = {}) 
+        const std::vector<std::tuple<int, int, int>>& sizes = {},
+        int id_offset = 0,
+        uint64_t seed = std::random_device{}())
     {
-        std::vector<nlohmann::json> boxes;
-        std::mt19937 rng(std::random_device{}());
-
-        if (sizes.empty())
-        {
-            for (int i = 0; i < num_boxes; ++i)
-            {
-                int x_size = std::uniform_int_distribution<int>(x_range.first, x_range.second)(rng);
-                int y_size = std::uniform_int_distribution<int>(y_range.first, y_range.second)(rng);
-                int z_size = std::uniform_int_distribution<int>(z_range.first, z_range.second)(rng);
-                if (x_size < y_size)
-                    std::swap(x_size, y_size);
-                nlohmann::json box;
-                box["box_id"] = i;
-                box["box_size"] = {x_size, y_size, z_size};
-                boxes.push_back(box);
-            }
-        }
-        else
-        {
-            if (static_cast<int>(sizes.size()) != num_boxes)
-            {
-                throw std::invalid_argument("Length of sizes must match num_boxes");
-            }
-            for (int i = 0; i < num_boxes; ++i)
-            {
-                nlohmann::json box;
-                box["box_id"] = i;
-                box["box_size"] = {std::get<0>(sizes[i]), std::get<1>(sizes[i]), std::get<2>(sizes[i])};
-                boxes.push_back(box);
-            }
-        }
-        return boxes;
+        return generate_boxes(num_boxes, x_range, y_range, z_range, sizes, id_offset, seed);
     }
 
+    // 작은 박스 75개 뒤에 붙도록 id 는 기본으로 75 부터 시작한다
     static std::vector<nlohmann::json> large_generate_boxes(
         int num_boxes,
         const std::pair<int, int>& x_range,
         const std::pair<int, int>& y_range,
         const std::pair<int, int>& z_range,
-        const std::vector<std::tuple<int, int, int>>& sizes = {}) 
+        const std::vector<std::tuple<int, int, int>>& sizes = {},
+        int id_offset = 75,
+        uint64_t seed = std::random_device{}())
+    {
+        return generate_boxes(num_boxes, x_range, y_range, z_range, sizes, id_offset, seed);
+    }
+
+private:
+    static std::vector<nlohmann::json> generate_boxes(
+        int num_boxes,
+        const std::pair<int, int>& x_range,
+        const std::pair<int, int>& y_range,
+        const std::pair<int, int>& z_range,
+        const std::vector<std::tuple<int, int, int>>& sizes,
+        int id_offset,
+        uint64_t seed)
     {
         std::vector<nlohmann::json> boxes;
-        std::mt19937 rng(std::random_device{}());
+        boxes.reserve(num_boxes);
+        std::mt19937 rng(static_cast<std::mt19937::result_type>(seed));
 
         if (sizes.empty())
         {
@@ -82,7 +71,7 @@ public:
                 if (x_size < y_size)
                     std::swap(x_size, y_size);
                 nlohmann::json box;
-                box["box_id"] = i + 75;
+                box["box_id"] = i + id_offset;
                 box["box_size"] = {x_size, y_size, z_size};
                 boxes.push_back(box);
             }
@@ -96,7 +85,7 @@ public:
             for (int i = 0; i < num_boxes; ++i)
             {
                 nlohmann::json box;
-                box["box_id"] = i + 75;
+                box["box_id"] = i + id_offset;
                 box["box_size"] = {std::get<0>(sizes[i]), std::get<1>(sizes[i]), std::get<2>(sizes[i])};
                 boxes.push_back(box);
             }
@@ -0,0 +1,24 @@
+#ifndef _BOX_RECORD
+#define _BOX_RECORD
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+// 입력 박스 하나. JSON/바이너리 로더가 DOM 없이 바로 채우는 고정 크기 레코드
+struct BoxRecord {
+    int box_id = 0;
+    std::array<int, 3> box_size = {0, 0, 0};
+    float weight = 0.0f;     // 없으면 0
+    uint32_t flags = 0;      // 취급 속성 비트 (예: 깨짐 주의). 없으면 0
+};
+
+// BoxRecord::flags 비트
+enum BoxFlags : uint32_t {
+    BOX_FLAG_FRAGILE = 1u << 0
+};
+
+// 로더가 레코드를 하나 해석할 때마다 호출된다
+using BoxRecordCallback = std::function<void(const BoxRecord&)>;
+
+#endif
@@ -0,0 +1,269 @@
+#ifndef _BOX_SET_FILE
+#define _BOX_SET_FILE
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "boxRecord.hpp"
+
+// Binary columnar box set.
+// File layout (little endian, 모든 열은 8바이트 정렬):
+//   Header (64 bytes): "BOXSET\0\0" magic, u32 version, u32 header_size, u64 count,
+//                      u64 ids/dims/weights/flags offsets, u64 checksum
+//   i32 ids[count] | i32 dims[count][3] | f32 weights[count] | u32 flags[count]
+// 읽을 때는 파일을 읽기 전용 공유 매핑으로 올리고 열 포인터만 잡으므로 파싱 비용이 없고,
+// 같은 호스트의 여러 프로세스가 페이지 캐시의 한 사본을 함께 쓴다.
+// checksum 은 header 이후 전체 payload 에 대한 64비트 word 단위 FNV-1a 이다
+class BoxSetFile {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    explicit BoxSetFile(const std::string& filename, bool verify_checksum = true)
+        : filename(filename)
+    {
+        if (map_file())
+        {
+            valid = validate(verify_checksum);
+            if (!valid)
+            {
+                unmap();
+            }
+        }
+    }
+
+    ~BoxSetFile()
+    {
+        unmap();
+    }
+
+    BoxSetFile(const BoxSetFile&) = delete;
+    BoxSetFile& operator=(const BoxSetFile&) = delete;
+
+    bool is_open() const { return valid; }
+    size_t size() const { return valid ? static_cast<size_t>(header.count) : 0; }
+
+    const int32_t* ids() const { return column<int32_t>(header.ids_offset); }
+    const int32_t* dims() const { return column<int32_t>(header.dims_offset); }       // box i 의 치수는 dims()[3 * i + axis]
+    const float* weights() const { return column<float>(header.weights_offset); }
+    const uint32_t* flags() const { return column<uint32_t>(header.flags_offset); }
+
+    BoxRecord record(size_t index) const
+    {
+        BoxRecord out;
+        out.box_id = ids()[index];
+        out.box_size = {dims()[3 * index], dims()[3 * index + 1], dims()[3 * index + 2]};
+        out.weight = weights()[index];
+        out.flags = flags()[index];
+        return out;
+    }
+
+    void for_each(const BoxRecordCallback& on_record) const
+    {
+        for (size_t i = 0; i < size(); i++)
+        {
+            on_record(record(i));
+        }
+    }
+
+    std::vector<BoxRecord> to_records() const
+    {
+        std::vector<BoxRecord> records;
+        records.reserve(size());
+        for_each([&](const BoxRecord& record) { records.push_back(record); });
+        return records;
+    }
+
+    static bool write(const std::string& filename, const std::vector<BoxRecord>& records)
+    {
+        const uint64_t count = records.size();
+        Header out{};
+        std::memcpy(out.magic, MAGIC, sizeof(out.magic));
+        out.version = VERSION;
+        out.header_size = sizeof(Header);
+        out.count = count;
+        out.ids_offset = sizeof(Header);
+        out.dims_offset = out.ids_offset + align8(count * sizeof(int32_t));
+        out.weights_offset = out.dims_offset + align8(count * 3 * sizeof(int32_t));
+        out.flags_offset = out.weights_offset + align8(count * sizeof(float));
+        const uint64_t file_size = out.flags_offset + align8(count * sizeof(uint32_t));
+
+        // 열 단위로 한 버퍼에 모은 뒤 checksum 을 계산해 한 번에 쓴다
+        std::vector<char> payload(file_size - sizeof(Header), 0);
+        auto* ids = reinterpret_cast<int32_t*>(payload.data() + (out.ids_offset - sizeof(Header)));
+        auto* dims = reinterpret_cast<int32_t*>(payload.data() + (out.dims_offset - sizeof(Header)));
+        auto* weights = reinterpret_cast<float*>(payload.data() + (out.weights_offset - sizeof(Header)));
+        auto* flags = reinterpret_cast<uint32_t*>(payload.data() + (out.flags_offset - sizeof(Header)));
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            ids[i] = records[i].box_id;
+            dims[3 * i] = records[i].box_size[0];
+            dims[3 * i + 1] = records[i].box_size[1];
+            dims[3 * i + 2] = records[i].box_size[2];
+            weights[i] = records[i].weight;
+            flags[i] = records[i].flags;
+        }
+        out.checksum = checksum(payload.data(), payload.size());
+
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "Can't open: " << filename << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&out), sizeof(out));
+        file.write(payload.data(), payload.size());
+        return static_cast<bool>(file);
+    }
+
+private:
+    static constexpr const char* MAGIC = "BOXSET\0\0";
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        uint64_t count;
+        uint64_t ids_offset;
+        uint64_t dims_offset;
+        uint64_t weights_offset;
+        uint64_t flags_offset;
+        uint64_t checksum;
+    };
+    static_assert(sizeof(Header) == 64, "BoxSetFile header must stay 64 bytes");
+
+    std::string filename;
+    Header header{};
+    bool valid = false;
+    const char* mapped_data = nullptr;
+    size_t mapped_size = 0;
+    std::vector<char> fallback_data;
+
+    static uint64_t align8(uint64_t bytes)
+    {
+        return (bytes + 7) & ~static_cast<uint64_t>(7);
+    }
+
+    static uint64_t checksum(const char* data, size_t bytes)
+    {
+        uint64_t hash = 1469598103934665603ULL;
+        for (size_t offset = 0; offset + 8 <= bytes; offset += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + offset, sizeof(word));
+            hash ^= word;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    const T* column(uint64_t offset) const
+    {
+        return valid ? reinterpret_cast<const T*>(mapped_data + offset) : nullptr;
+    }
+
+    bool map_file()
+    {
+        std::error_code ec;
+        if (!std::filesystem::exists(filename, ec))
+        {
+            std::cerr << "Can't open: " << filename << std::endl;
+            return false;
+        }
+
+#ifndef _WIN32
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            std::cerr << "Can't open: " << filename << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            // 읽기 전용 공유 매핑: 다른 프로세스와 같은 물리 페이지를 쓴다
+            void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                mapped_data = static_cast<const char*>(addr);
+                mapped_size = static_cast<size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+#else
+        std::ifstream file(filename, std::ios::binary);
+        fallback_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        mapped_data = fallback_data.data();
+        mapped_size = fallback_data.size();
+#endif
+        return mapped_data != nullptr;
+    }
+
+    bool validate(bool verify_checksum)
+    {
+        if (mapped_size < sizeof(Header))
+        {
+            std::cerr << "Invalid box set (truncated header): " << filename << std::endl;
+            return false;
+        }
+        std::memcpy(&header, mapped_data, sizeof(Header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.header_size != sizeof(Header))
+        {
+            std::cerr << "Invalid box set: " << filename << std::endl;
+            return false;
+        }
+        if (header.version != VERSION)
+        {
+            std::cerr << "Unsupported box set version " << header.version << ": " << filename << std::endl;
+            return false;
+        }
+
+        const uint64_t count = header.count;
+        if (count > mapped_size ||
+            header.ids_offset != sizeof(Header) ||
+            header.dims_offset != header.ids_offset + align8(count * sizeof(int32_t)) ||
+            header.weights_offset != header.dims_offset + align8(count * 3 * sizeof(int32_t)) ||
+            header.flags_offset != header.weights_offset + align8(count * sizeof(float)) ||
+            header.flags_offset + align8(count * sizeof(uint32_t)) != mapped_size)
+        {
+            std::cerr << "Invalid box set (column layout): " << filename << std::endl;
+            return false;
+        }
+
+        valid = true;
+        if (verify_checksum && checksum(mapped_data + sizeof(Header), mapped_size - sizeof(Header)) != header.checksum)
+        {
+            std::cerr << "Box set checksum mismatch: " << filename << std::endl;
+            valid = false;
+        }
+        return valid;
+    }
+
+    void unmap()
+    {
+#ifndef _WIN32
+        if (mapped_data)
+        {
+            ::munmap(const_cast<char*>(mapped_data), mapped_size);
+        }
+#endif
+        fallback_data.clear();
+        mapped_data = nullptr;
+        mapped_size = 0;
+        valid = false;
+    }
+};
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef _COW_VECTOR
+#define _COW_VECTOR
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+// Chunked copy-on-write vector.
+// 복사(fork)는 chunk 테이블 포인터 하나만 공유하므로 O(1) 이고,
+// 수정하는 쪽만 테이블과 수정된 chunk 를 복제한다. 동시 수정은 지원하지 않는다.
+template <typename T, size_t ChunkSize = 256>
+class CowVector {
+private:
+    struct Chunk {
+        std::vector<T> items;
+    };
+
+    struct Table {
+        std::vector<std::shared_ptr<Chunk>> chunks;
+        size_t size = 0;
+    };
+
+    std::shared_ptr<Table> table;
+
+    Table& mutable_table()
+    {
+        if (!table)
+        {
+            table = std::make_shared<Table>();
+        }
+        else if (table.use_count() > 1)
+        {
+            table = std::make_shared<Table>(*table);
+        }
+        return *table;
+    }
+
+    Chunk& mutable_chunk(size_t chunk_index)
+    {
+        Table& t = mutable_table();
+        auto& chunk = t.chunks[chunk_index];
+        if (chunk.use_count() > 1)
+        {
+            chunk = std::make_shared<Chunk>(*chunk);
+        }
+        return *chunk;
+    }
+
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+        const_iterator(const Table* table, size_t index)
+            : table(table)
+        {
+            if (!table || index >= table->size)
+                return;
+            chunk = index / ChunkSize;
+            const auto& items = table->chunks[chunk]->items;
+            current = items.data() + index % ChunkSize;
+            chunk_end = items.data() + items.size();
+        }
+
+        reference operator*() const { return *current; }
+        pointer operator->() const { return current; }
+
+        const_iterator& operator++()
+        {
+            if (++current == chunk_end)
+            {
+                next_chunk();
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator prev = *this;
+            ++(*this);
+            return prev;
+        }
+
+        // end 는 current 가 nullptr 인 상태로 표현된다
+        bool operator==(const const_iterator& other) const { return current == other.current; }
+        bool operator!=(const const_iterator& other) const { return current != other.current; }
+
+        size_t position() const
+        {
+            if (!current)
+                return table ? table->size : 0;
+            return chunk * ChunkSize + (current - table->chunks[chunk]->items.data());
+        }
+
+    private:
+        const Table* table = nullptr;
+        size_t chunk = 0;
+        const T* current = nullptr;
+        const T* chunk_end = nullptr;
+
+        void next_chunk()
+        {
+            if (++chunk < table->chunks.size() && !table->chunks[chunk]->items.empty())
+            {
+                const auto& items = table->chunks[chunk]->items;
+                current = items.data();
+                chunk_end = items.data() + items.size();
+            }
+            else
+            {
+                current = chunk_end = nullptr;
+            }
+        }
+    };
+
+    CowVector() = default;
+
+    CowVector(size_t count, const T& value)
+    {
+        assign(count, value);
+    }
+
+    size_t size() const { return table ? table->size : 0; }
+    bool empty() const { return size() == 0; }
+
+    const T& operator[](size_t index) const
+    {
+        return table->chunks[index / ChunkSize]->items[index % ChunkSize];
+    }
+
+    const T& back() const { return (*this)[size() - 1]; }
+
+    const_iterator begin() const { return const_iterator(table.get(), 0); }
+    const_iterator end() const { return const_iterator(table.get(), size()); }
+
+    void set(size_t index, const T& value)
+    {
+        mutable_chunk(index / ChunkSize).items[index % ChunkSize] = value;
+    }
+
+    void push_back(const T& value)
+    {
+        Table& t = mutable_table();
+        if (t.size % ChunkSize == 0)
+        {
+            auto chunk = std::make_shared<Chunk>();
+            chunk->items.reserve(ChunkSize);
+            t.chunks.push_back(std::move(chunk));
+        }
+        mutable_chunk(t.size / ChunkSize).items.push_back(value);
+        t.size++;
+    }
+
+    void pop_back()
+    {
+        Table& t = mutable_table();
+        size_t last = t.size - 1;
+        if (last % ChunkSize == 0)
+        {
+            t.chunks.pop_back();
+        }
+        else
+        {
+            mutable_chunk(last / ChunkSize).items.pop_back();
+        }
+        t.size--;
+    }
+
+    // index 이후의 원소를 한 칸씩 당긴다. 앞쪽 chunk 는 계속 공유된다
+    void erase(size_t index)
+    {
+        for (size_t i = index; i + 1 < size(); i++)
+        {
+            set(i, (*this)[i + 1]);
+        }
+        pop_back();
+    }
+
+    void erase(const const_iterator& it)
+    {
+        erase(it.position());
+    }
+
+    void assign(size_t count, const T& value)
+    {
+        table = std::make_shared<Table>();
+        for (size_t begin = 0; begin < count; begin += ChunkSize)
+        {
+            auto chunk = std::make_shared<Chunk>();
+            chunk->items.assign(std::min(ChunkSize, count - begin), value);
+            table->chunks.push_back(std::move(chunk));
+        }
+        table->size = count;
+    }
+
+    void clear()
+    {
+        table.reset();
+    }
+
+    std::vector<T> to_vector() const
+    {
+        std::vector<T> out;
+        out.reserve(size());
+        for (const auto& item : *this)
+        {
+            out.push_back(item);
+        }
+        return out;
+    }
+};
+
+// 점유 격자용 copy-on-write 비트셋. 64비트 word 단위로 chunk 에 저장한다
+class CowBitGrid {
+public:
+    CowBitGrid() = default;
+
+    explicit CowBitGrid(size_t bit_count)
+        : bit_count(bit_count), words((bit_count + 63) / 64, 0)
+    {}
+
+    size_t size() const { return bit_count; }
+
+    bool test(size_t index) const
+    {
+        return (words[index >> 6] >> (index & 63)) & 1ULL;
+    }
+
+    void set(size_t index, bool value)
+    {
+        uint64_t word = words[index >> 6];
+        uint64_t mask = 1ULL << (index & 63);
+        uint64_t updated = value ? (word | mask) : (word & ~mask);
+        if (updated != word)
+        {
+            words.set(index >> 6, updated);
+        }
+    }
+
+    static size_t word_index(size_t index) { return index >> 6; }
+
+    uint64_t word(size_t word_index) const
+    {
+        return words[word_index];
+    }
+
+    void set_word(size_t word_index, uint64_t value)
+    {
+        if (words[word_index] != value)
+        {
+            words.set(word_index, value);
+        }
+    }
+
+private:
+    size_t bit_count = 0;
+    CowVector<uint64_t, 1024> words;
+};
+
+#endif
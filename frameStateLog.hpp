@@ -0,0 +1,270 @@
+#ifndef _FRAME_STATE_LOG
+#define _FRAME_STATE_LOG
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+#include "geometryTypes.hpp"
+
+// Append-only pallet state log for animations.
+// 프레임마다 전체 상태를 복사하지 않고 배치/이동/제거 이벤트만 쌓는다.
+// frame_end[k] 는 프레임 k+1 까지의 이벤트 수이므로 어느 프레임이든 로그 앞부분을 재생한 결과가 그 프레임의 상태다.
+// 박스는 box_id 로 찾으므로 이동/제거는 팔렛트 크기와 무관하다.
+// 메모리는 이벤트 수에 비례하고, Cursor 로 앞으로만 진행하면 전체 재생도 이벤트 수에 비례한다
+class FrameStateLog {
+public:
+    // StackResult::pallet_id 와 같은 번호
+    static constexpr int MAIN_PALLET = 1;
+    static constexpr int BUFFER_PALLET = 2;
+
+    enum class EventType : uint8_t {
+        PLACE,      // pallet 에 box 추가
+        MOVE,       // from_pallet 의 removed 박스를 빼고 pallet 에 box 추가
+        REMOVE      // pallet 의 handle 박스 제거
+    };
+
+    struct Event {
+        EventType type;
+        int pallet;
+        int from_pallet;
+        uint32_t handle;        // PLACE/MOVE: 새 박스의 handle, REMOVE: 지울 박스의 handle
+        uint32_t removed;       // MOVE: from_pallet 에서 지울 박스의 handle
+        OBB box;
+    };
+
+private:
+    static constexpr size_t PALLET_COUNT = 2;
+
+public:
+    // 같은 pallet 에 같은 box_id 가 이미 있으면 나중 박스가 그 id 를 갖는다 (앞선 박스는 그대로 남는다)
+    void place(int pallet_id, int box_id, const OBB& box)
+    {
+        uint32_t handle = next_handle++;
+        events.push_back({EventType::PLACE, pallet_id, pallet_id, handle, 0, box});
+        live[slot(pallet_id)][box_id] = handle;
+    }
+
+    // from_pallet 의 box_id 박스를 빼고 to_pallet 에 box 로 놓는다. from_pallet 에 없으면 아무것도 하지 않는다
+    bool move(int from_pallet, int to_pallet, int box_id, const OBB& box)
+    {
+        auto& from = live[slot(from_pallet)];
+        auto it = from.find(box_id);
+        if (it == from.end())
+            return false;
+
+        uint32_t handle = next_handle++;
+        events.push_back({EventType::MOVE, to_pallet, from_pallet, handle, it->second, box});
+        from.erase(it);
+        live[slot(to_pallet)][box_id] = handle;
+        return true;
+    }
+
+    bool remove(int pallet_id, int box_id)
+    {
+        auto& pallet = live[slot(pallet_id)];
+        auto it = pallet.find(box_id);
+        if (it == pallet.end())
+            return false;
+
+        events.push_back({EventType::REMOVE, pallet_id, pallet_id, it->second, 0, OBB{}});
+        pallet.erase(it);
+        return true;
+    }
+
+    bool contains(int pallet_id, int box_id) const
+    {
+        return live[slot(pallet_id)].count(box_id) > 0;
+    }
+
+    // 지금까지의 이벤트로 프레임 하나를 끝낸다
+    void end_frame()
+    {
+        frame_end.push_back(events.size());
+    }
+
+    int frame_count() const { return static_cast<int>(frame_end.size()); }
+
+    // 로그를 앞으로만 재생하는 읽기 전용 view. worker 마다 하나씩 둔다.
+    // 지운 박스는 handle 로 표시만 해 두고 (tombstone) state() 가 건너뛰므로 이동/제거 한 번은 상수 시간이다.
+    // 표시된 박스가 남은 박스보다 많아질 때만 걷어 내므로 정리 비용도 박스 하나당 상수로 나뉜다.
+    // 박스 순서 (배치 순서) 는 그대로 유지된다
+    class Cursor {
+    private:
+        // 박스 순서는 배치 순서를 유지한다
+        struct PalletState {
+            std::vector<OBB> boxes;
+            std::vector<uint32_t> handles;
+            size_t removed_count = 0;
+        };
+
+    public:
+        // 한 팔렛트의 현재 박스를 배치 순서대로 훑는다. 지워진 박스는 건너뛴다
+        class PalletView {
+        public:
+            class iterator {
+            public:
+                iterator(const PalletState* pallet, const std::vector<uint8_t>* removed, size_t index)
+                    : pallet(pallet), removed(removed), index(index)
+                {
+                    skip_removed();
+                }
+
+                const OBB& operator*() const { return pallet->boxes[index]; }
+                const OBB* operator->() const { return &pallet->boxes[index]; }
+
+                iterator& operator++()
+                {
+                    index++;
+                    skip_removed();
+                    return *this;
+                }
+
+                bool operator==(const iterator& other) const { return index == other.index; }
+                bool operator!=(const iterator& other) const { return index != other.index; }
+
+            private:
+                const PalletState* pallet;
+                const std::vector<uint8_t>* removed;
+                size_t index;
+
+                void skip_removed()
+                {
+                    while (index < pallet->handles.size() && (*removed)[pallet->handles[index]])
+                    {
+                        index++;
+                    }
+                }
+            };
+
+            PalletView(const PalletState& pallet, const std::vector<uint8_t>& removed)
+                : pallet(&pallet), removed(&removed)
+            {}
+
+            iterator begin() const { return iterator(pallet, removed, 0); }
+            iterator end() const { return iterator(pallet, removed, pallet->handles.size()); }
+            size_t size() const { return pallet->handles.size() - pallet->removed_count; }
+            bool empty() const { return size() == 0; }
+
+        private:
+            const PalletState* pallet;
+            const std::vector<uint8_t>* removed;
+        };
+
+        explicit Cursor(const FrameStateLog& log)
+            : log(&log), removed(log.next_handle, 0)
+        {}
+
+        // 프레임 frame (1 부터) 의 상태로 맞춘다. 뒤로 가면 처음부터 다시 재생한다
+        void seek(int frame)
+        {
+            // Cursor 를 만든 뒤에 로그가 더 자랐을 수 있다
+            if (removed.size() < log->next_handle)
+            {
+                removed.resize(log->next_handle, 0);
+            }
+
+            size_t target = frame <= 0 ? 0 : log->frame_end[std::min(frame, log->frame_count()) - 1];
+            if (target < applied)
+            {
+                for (auto& pallet : pallets)
+                {
+                    pallet.boxes.clear();
+                    pallet.handles.clear();
+                    pallet.removed_count = 0;
+                }
+                std::fill(removed.begin(), removed.end(), 0);
+                applied = 0;
+            }
+            for (; applied < target; applied++)
+            {
+                apply(log->events[applied]);
+            }
+        }
+
+        PalletView state(int pallet_id) const
+        {
+            return PalletView(pallets[slot(pallet_id)], removed);
+        }
+
+    private:
+        const FrameStateLog* log;
+        size_t applied = 0;
+        std::array<PalletState, PALLET_COUNT> pallets;
+        std::vector<uint8_t> removed;       // handle -> 지워졌으면 1
+
+        void apply(const Event& event)
+        {
+            if (event.type == EventType::MOVE)
+            {
+                mark_removed(pallets[slot(event.from_pallet)], event.removed);
+            }
+            if (event.type == EventType::REMOVE)
+            {
+                mark_removed(pallets[slot(event.pallet)], event.handle);
+                return;
+            }
+            pallets[slot(event.pallet)].boxes.push_back(event.box);
+            pallets[slot(event.pallet)].handles.push_back(event.handle);
+        }
+
+        void mark_removed(PalletState& pallet, uint32_t handle)
+        {
+            removed[handle] = 1;
+            pallet.removed_count++;
+            if (pallet.removed_count * 2 > pallet.handles.size())
+            {
+                compact(pallet);
+            }
+        }
+
+        // 표시된 박스를 걷어 낸다. 남는 박스를 연속 구간 단위로 앞으로 당긴다
+        void compact(PalletState& pallet)
+        {
+            const size_t count = pallet.handles.size();
+            auto alive = [&](size_t i) { return !removed[pallet.handles[i]]; };
+            size_t kept = 0;
+            while (kept < count && alive(kept))
+            {
+                kept++;
+            }
+            size_t i = kept;
+            while (i < count)
+            {
+                if (!alive(i))
+                {
+                    i++;
+                    continue;
+                }
+                size_t run = i;
+                while (i < count && alive(i))
+                {
+                    i++;
+                }
+                std::copy(pallet.boxes.begin() + run, pallet.boxes.begin() + i, pallet.boxes.begin() + kept);
+                std::copy(pallet.handles.begin() + run, pallet.handles.begin() + i, pallet.handles.begin() + kept);
+                kept += i - run;
+            }
+            pallet.boxes.resize(kept);
+            pallet.handles.resize(kept);
+            pallet.removed_count = 0;
+        }
+    };
+
+private:
+    std::vector<Event> events;
+    std::vector<size_t> frame_end;
+    uint32_t next_handle = 0;
+
+    // 로그를 만드는 동안의 현재 상태 (box_id -> handle). 이동/제거할 박스를 찾는 데 쓴다
+    std::array<std::unordered_map<int, uint32_t>, PALLET_COUNT> live;
+
+    static size_t slot(int pallet_id)
+    {
+        return pallet_id == BUFFER_PALLET ? 1 : 0;
+    }
+};
+
+#endif
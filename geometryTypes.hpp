@@ -0,0 +1,85 @@
+#ifndef _GEOMETRY_TYPES
+#define _GEOMETRY_TYPES
+
+#include <array>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+// Fixed-size geometry value types.
+// 모두 힙 할당이 없는 trivially copyable 타입이라 memcpy 나 연속 배열 저장이 그대로 가능하다.
+// 기존 vector 기반 코드와 맞추기 위해 [] 로 축 인덱스 접근을 지원한다
+
+struct Vec2 {
+    double x;
+    double y;
+
+    double& operator[](size_t axis) { return axis == 0 ? x : y; }
+    double operator[](size_t axis) const { return axis == 0 ? x : y; }
+};
+
+struct Vec3 {
+    double x;
+    double y;
+    double z;
+
+    double& operator[](size_t axis) { return axis == 0 ? x : (axis == 1 ? y : z); }
+    double operator[](size_t axis) const { return axis == 0 ? x : (axis == 1 ? y : z); }
+};
+
+struct Vec3i {
+    int x;
+    int y;
+    int z;
+
+    int& operator[](size_t axis) { return axis == 0 ? x : (axis == 1 ? y : z); }
+    int operator[](size_t axis) const { return axis == 0 ? x : (axis == 1 ? y : z); }
+
+    long long volume() const { return static_cast<long long>(x) * y * z; }
+};
+
+// 회전된 직사각형의 네 꼭짓점 (반시계 방향)
+using Quad = std::array<Vec2, 4>;
+
+// 정수 격자 위의 축 정렬 박스. origin 은 최소 꼭짓점
+struct AABB {
+    Vec3i origin;
+    Vec3i size;
+
+    Vec3i max() const
+    {
+        return {origin.x + size.x, origin.y + size.y, origin.z + size.z};
+    }
+
+    bool overlaps(const AABB& other) const
+    {
+        return origin.x < other.origin.x + other.size.x && other.origin.x < origin.x + size.x &&
+               origin.y < other.origin.y + other.size.y && other.origin.y < origin.y + size.y &&
+               origin.z < other.origin.z + other.size.z && other.origin.z < origin.z + size.z;
+    }
+
+    bool contains(const AABB& inner) const
+    {
+        return inner.origin.x >= origin.x && inner.origin.y >= origin.y && inner.origin.z >= origin.z &&
+               inner.origin.x + inner.size.x <= origin.x + size.x &&
+               inner.origin.y + inner.size.y <= origin.y + size.y &&
+               inner.origin.z + inner.size.z <= origin.z + size.z;
+    }
+};
+
+// z 축으로만 회전된 박스: 바닥면 꼭짓점과 바닥 높이, 박스 높이
+struct OBB {
+    Quad corners;
+    double z;
+    double height;
+
+    double z_top() const { return z + height; }
+};
+
+static_assert(std::is_trivially_copyable<Vec2>::value, "Vec2 must be trivially copyable");
+static_assert(std::is_trivially_copyable<Vec3>::value, "Vec3 must be trivially copyable");
+static_assert(std::is_trivially_copyable<Vec3i>::value, "Vec3i must be trivially copyable");
+static_assert(std::is_trivially_copyable<AABB>::value, "AABB must be trivially copyable");
+static_assert(std::is_trivially_copyable<OBB>::value, "OBB must be trivially copyable");
+
+#endif
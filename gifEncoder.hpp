@@ -0,0 +1,269 @@
+#ifndef _GIF_ENCODER
+#define _GIF_ENCODER
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include <gif_lib.h>
+#include <opencv2/opencv.hpp>
+
+#include "paletteQuantizer.hpp"
+
+// Streaming GIF writer.
+// open() 으로 파일, 화면 크기, 팔레트를 정하고, add_frame() 으로 받은 프레임을 바로 팔레트 인덱스로 바꿔 인코딩한다.
+// 두 번째 프레임부터는 직전 프레임과 달라진 사각형만 쓰고(DISPOSE_DO_NOT), 그 안에서도 바뀌지 않은 픽셀은
+// 투명 인덱스로 둔다. 직전과 같은 프레임은 쓰지 않고 앞 프레임의 표시 시간을 늘린다.
+// 그래서 마지막 한 장은 다음 프레임이 올 때까지 (또는 close() 까지) 들고 있다.
+// 메모리에는 인덱스 버퍼 두 장과 아직 쓰지 않은 사각형 하나만 남는다
+class GifEncoder {
+public:
+    GifEncoder() = default;
+
+    ~GifEncoder()
+    {
+        close();
+    }
+
+    GifEncoder(const GifEncoder&) = delete;
+    GifEncoder& operator=(const GifEncoder&) = delete;
+
+    // delay 는 프레임 하나의 표시 시간 (1/100 초). 팔레트는 모든 프레임이 같이 쓰는 전역 color map 이 된다
+    bool open(const std::string& filename, int width, int height, int delay = 10,
+              const PaletteQuantizer& quantizer = PaletteQuantizer::fixed())
+    {
+        close();
+
+        int error_code = 0;
+        gif = EGifOpenFileName(filename.c_str(), false, &error_code);
+        if (!gif)
+        {
+            std::cerr << "Can't open GIF: " << filename << " (" << GifErrorString(error_code) << ")" << std::endl;
+            return false;
+        }
+        // Graphics Control Extension (지연, 투명, disposal) 을 쓰므로 GIF89a
+        EGifSetGifVersion(gif, true);
+
+        // 투명 인덱스는 quantizer 가 어떤 픽셀에도 주지 않는다
+        color_map = GifMakeMapObject(256, NULL);
+        if (!color_map)
+        {
+            EGifCloseFile(gif, &error_code);
+            gif = nullptr;
+            return false;
+        }
+        const auto& colors = quantizer.palette();
+        for (int i = 0; i < 256; i++)
+        {
+            color_map->Colors[i].Red = colors[i].red;
+            color_map->Colors[i].Green = colors[i].green;
+            color_map->Colors[i].Blue = colors[i].blue;
+        }
+
+        if (EGifPutScreenDesc(gif, width, height, 8, 0, color_map) == GIF_ERROR)
+        {
+            std::cerr << "Failed to write GIF header: " << filename << std::endl;
+            close();
+            return false;
+        }
+
+        palette = quantizer;
+        transparent_index = static_cast<GifByteType>(quantizer.transparent_index());
+        screen_width = width;
+        screen_height = height;
+        frame_delay = delay;
+        frames = 0;
+        images = 0;
+        has_pending = false;
+        indices.assign(static_cast<size_t>(width) * height, 0);
+        previous.assign(static_cast<size_t>(width) * height, 0);
+        return true;
+    }
+
+    // BGR 8UC3 프레임. 크기는 open() 때와 같아야 한다
+    bool add_frame(const cv::Mat& frame)
+    {
+        if (frame.empty() || frame.type() != CV_8UC3)
+        {
+            std::cerr << "GIF frame must be a BGR image" << std::endl;
+            return false;
+        }
+        return add_frame(frame.ptr<uint8_t>(0), frame.cols, frame.rows, frame.step);
+    }
+
+    // 원시 BGR 버퍼 (행 간격 stride 바이트)
+    bool add_frame(const uint8_t* pixels, int width, int height, size_t stride)
+    {
+        if (!gif)
+            return false;
+        if (width != screen_width || height != screen_height)
+        {
+            std::cerr << "GIF frame size " << width << "x" << height << " does not match "
+                      << screen_width << "x" << screen_height << std::endl;
+            return false;
+        }
+
+        palette.quantize(pixels, width, height, stride, indices.data());
+
+        Rect dirty = {0, 0, width, height};
+        if (frames > 0)
+        {
+            if (!find_dirty_rect(dirty))
+            {
+                // 직전 프레임과 같으면 쓰지 않고 보여 주는 시간만 늘린다
+                pending_delay += frame_delay;
+                frames++;
+                return true;
+            }
+        }
+
+        if (!flush_pending())
+            return false;
+
+        // 바뀐 사각형만 떼어 두고, 그 안에서 바뀌지 않은 픽셀은 투명하게 한다
+        pending.resize(static_cast<size_t>(dirty.width) * dirty.height);
+        for (int y = 0; y < dirty.height; y++)
+        {
+            size_t offset = static_cast<size_t>(dirty.y + y) * width + dirty.x;
+            const GifByteType* current_row = &indices[offset];
+            const GifByteType* previous_row = &previous[offset];
+            GifByteType* out = &pending[static_cast<size_t>(y) * dirty.width];
+            for (int x = 0; x < dirty.width; x++)
+            {
+                out[x] = (frames > 0 && current_row[x] == previous_row[x]) ? transparent_index : current_row[x];
+            }
+        }
+        pending_rect = dirty;
+        pending_delay = frame_delay;
+        has_pending = true;
+
+        indices.swap(previous);
+        frames++;
+        return true;
+    }
+
+    bool close()
+    {
+        bool ok = true;
+        if (gif)
+        {
+            ok = flush_pending();
+            int error_code = 0;
+            ok = EGifCloseFile(gif, &error_code) != GIF_ERROR && ok;
+            gif = nullptr;
+        }
+        if (color_map)
+        {
+            GifFreeMapObject(color_map);
+            color_map = nullptr;
+        }
+        return ok;
+    }
+
+    bool is_open() const { return gif != nullptr; }
+    // add_frame() 으로 받은 프레임 수 (건너뛴 같은 프레임 포함)
+    int frame_count() const { return frames; }
+    // 파일에 실제로 쓴 이미지 수
+    int image_count() const { return images; }
+
+private:
+    struct Rect {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    GifFileType* gif = nullptr;
+    ColorMapObject* color_map = nullptr;
+    PaletteQuantizer palette;
+    GifByteType transparent_index = 0;
+    int screen_width = 0;
+    int screen_height = 0;
+    int frame_delay = 10;
+    int frames = 0;
+    int images = 0;
+    std::vector<GifByteType> indices;       // 지금 프레임
+    std::vector<GifByteType> previous;      // 직전 프레임 (화면에 남아 있는 상태)
+
+    // 아직 쓰지 않은 마지막 이미지. 다음에 같은 프레임이 오면 지연만 늘어난다
+    std::vector<GifByteType> pending;
+    Rect pending_rect = {0, 0, 0, 0};
+    int pending_delay = 0;
+    bool has_pending = false;
+
+    // indices 와 previous 가 다른 영역의 경계 사각형. 같으면 false
+    bool find_dirty_rect(Rect& rect) const
+    {
+        const size_t row_bytes = static_cast<size_t>(screen_width);
+        int top = -1;
+        int bottom = -1;
+        int left = screen_width;
+        int right = -1;
+        for (int y = 0; y < screen_height; y++)
+        {
+            const GifByteType* current_row = &indices[y * row_bytes];
+            const GifByteType* previous_row = &previous[y * row_bytes];
+            if (std::memcmp(current_row, previous_row, row_bytes) == 0)
+                continue;
+
+            if (top < 0)
+                top = y;
+            bottom = y;
+            int x = 0;
+            while (x < left && current_row[x] == previous_row[x])
+            {
+                x++;
+            }
+            left = std::min(left, x);
+            x = screen_width - 1;
+            while (x > right && current_row[x] == previous_row[x])
+            {
+                x--;
+            }
+            right = std::max(right, x);
+        }
+        if (top < 0)
+            return false;
+
+        rect = {left, top, right - left + 1, bottom - top + 1};
+        return true;
+    }
+
+    bool flush_pending()
+    {
+        if (!has_pending)
+            return true;
+        has_pending = false;
+
+        GraphicsControlBlock gcb;
+        gcb.DisposalMode = DISPOSE_DO_NOT;
+        gcb.UserInputFlag = false;
+        gcb.DelayTime = pending_delay;
+        gcb.TransparentColor = images > 0 ? transparent_index : NO_TRANSPARENT_COLOR;
+        GifByteType extension[4];
+        size_t length = EGifGCBToExtension(&gcb, extension);
+
+        if (EGifPutExtension(gif, GRAPHICS_EXT_FUNC_CODE, static_cast<int>(length), extension) == GIF_ERROR ||
+            EGifPutImageDesc(gif, pending_rect.x, pending_rect.y, pending_rect.width, pending_rect.height, false, nullptr) == GIF_ERROR)
+        {
+            std::cerr << "Failed to write GIF frame " << images + 1 << std::endl;
+            return false;
+        }
+        for (int y = 0; y < pending_rect.height; y++)
+        {
+            if (EGifPutLine(gif, &pending[static_cast<size_t>(y) * pending_rect.width], pending_rect.width) == GIF_ERROR)
+            {
+                std::cerr << "Failed to write GIF frame " << images + 1 << std::endl;
+                return false;
+            }
+        }
+        images++;
+        return true;
+    }
+};
+
+#endif
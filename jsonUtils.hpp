@@ -5,9 +5,183 @@
 #include <fstream>
 #include <iomanip>
 #include <string>
+#include <vector>
+#include <cmath>
+#include <climits>
+#include <cstdint>
+#include <limits>
 
 #include <nlohmann/json.hpp>
 
+#include "boxRecord.hpp"
+#include "boxSetFile.hpp"
+
+// 박스 목록([{"box_id": .., "box_size": [x, y, z]}, ...])을 SAX 로 읽는 핸들러.
+// DOM 을 만들지 않고 레코드가 끝날 때마다 콜백으로 넘기므로 메모리는 박스 수와 무관하다.
+// 알 수 없는 키의 값은 깊이만 추적하며 건너뛴다. 필드가 빠졌거나 값이 범위를 벗어난 레코드는 건너뛴다
+class BoxRecordSax : public nlohmann::json_sax<nlohmann::json> {
+public:
+    explicit BoxRecordSax(const BoxRecordCallback& on_record)
+        : on_record(on_record)
+    {}
+
+    size_t record_count = 0;
+    size_t skipped_count = 0;
+
+    bool null() override { return value_end(); }
+    bool boolean(bool) override { return value_end(); }
+    bool number_integer(number_integer_t val) override { return number(static_cast<long long>(val)); }
+    bool number_unsigned(number_unsigned_t val) override
+    {
+        return number(val > static_cast<number_unsigned_t>(LLONG_MAX) ? LLONG_MAX : static_cast<long long>(val));
+    }
+    bool number_float(number_float_t val, const string_t&) override
+    {
+        if (depth == RECORD_DEPTH && field == Field::WEIGHT)
+        {
+            current.weight = static_cast<float>(val);
+            return value_end();
+        }
+        // llround 는 long long 범위 밖에서 정의되지 않으므로 범위 밖임이 분명한 값으로 바꿔 넘긴다
+        if (!(std::fabs(val) < 1e18))
+            return number(LLONG_MAX);
+        return number(std::llround(val));
+    }
+    bool string(string_t&) override { return value_end(); }
+    bool binary(binary_t&) override { return value_end(); }
+
+    bool start_object(std::size_t) override
+    {
+        depth++;
+        if (depth == RECORD_DEPTH)
+        {
+            current = BoxRecord{};
+            has_id = false;
+            size_count = 0;
+            out_of_range = false;
+        }
+        return true;
+    }
+
+    bool end_object() override
+    {
+        if (depth == RECORD_DEPTH)
+        {
+            if (out_of_range)
+            {
+                std::cerr << "Skipping box record #" << (record_count + skipped_count) << " with out-of-range value" << std::endl;
+                skipped_count++;
+            }
+            else if (has_id && size_count == 3)
+            {
+                on_record(current);
+                record_count++;
+            }
+            else
+            {
+                std::cerr << "Skipping incomplete box record #" << (record_count + skipped_count) << std::endl;
+                skipped_count++;
+            }
+        }
+        depth--;
+        return value_end();
+    }
+
+    bool start_array(std::size_t) override
+    {
+        depth++;
+        return true;
+    }
+
+    bool end_array() override
+    {
+        depth--;
+        return value_end();
+    }
+
+    bool key(string_t& val) override
+    {
+        if (depth == RECORD_DEPTH)
+        {
+            if (val == "box_id")
+                field = Field::BOX_ID;
+            else if (val == "box_size")
+                field = Field::BOX_SIZE;
+            else if (val == "weight")
+                field = Field::WEIGHT;
+            else if (val == "flags")
+                field = Field::FLAGS;
+            else
+                field = Field::OTHER;
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& ex) override
+    {
+        std::cerr << "JSON parse error at byte " << position << ": " << ex.what() << std::endl;
+        return false;
+    }
+
+private:
+    // 최상위 배열 = 1, 박스 객체 = 2, box_size 배열 = 3
+    static constexpr int RECORD_DEPTH = 2;
+
+    enum class Field { OTHER, BOX_ID, BOX_SIZE, WEIGHT, FLAGS };
+
+    const BoxRecordCallback& on_record;
+    BoxRecord current;
+    bool has_id = false;
+    int size_count = 0;
+    bool out_of_range = false;  // box_id, box_size 가 int32 를, flags 가 uint32 를 벗어남
+    int depth = 0;
+    Field field = Field::OTHER;
+
+    bool number(long long val)
+    {
+        if (depth == RECORD_DEPTH && field == Field::BOX_ID)
+        {
+            out_of_range = out_of_range || !fits_int(val);
+            current.box_id = static_cast<int>(val);
+            has_id = true;
+        }
+        else if (depth == RECORD_DEPTH && field == Field::WEIGHT)
+        {
+            current.weight = static_cast<float>(val);
+        }
+        else if (depth == RECORD_DEPTH && field == Field::FLAGS)
+        {
+            out_of_range = out_of_range || val < 0 || val > static_cast<long long>(UINT32_MAX);
+            current.flags = static_cast<uint32_t>(val);
+        }
+        else if (depth == RECORD_DEPTH + 1 && field == Field::BOX_SIZE)
+        {
+            if (size_count < 3)
+            {
+                out_of_range = out_of_range || !fits_int(val);
+                current.box_size[size_count] = static_cast<int>(val);
+            }
+            size_count++;
+        }
+        return value_end();
+    }
+
+    static bool fits_int(long long val)
+    {
+        return val >= std::numeric_limits<int>::min() && val <= std::numeric_limits<int>::max();
+    }
+
+    // 박스 객체 안에서 값 하나가 끝나면 다음 키를 기다린다
+    bool value_end()
+    {
+        if (depth == RECORD_DEPTH)
+        {
+            field = Field::OTHER;
+        }
+        return true;
+    }
+};
+
 // JSON utility functions
 class JsonUtils {
 public:
@@ -32,6 +206,81 @@ public:
         }
         return data;
     }
+
+    // 파일 전체를 DOM 으로 올리지 않고 박스 레코드를 하나씩 콜백으로 넘긴다.
+    // 콜백은 파일을 읽는 도중에 호출되므로 다 읽기 전에 후속 처리를 시작할 수 있다.
+    // 파일을 열 수 없거나 JSON 이 잘렸거나 잘못되었으면 false. 그때까지 넘긴 레코드는 불완전한 목록이다
+    static bool stream_box_records(const std::string& filename, const BoxRecordCallback& on_record)
+    {
+        std::vector<char> read_buffer(1 << 16);
+        std::ifstream file;
+        file.rdbuf()->pubsetbuf(read_buffer.data(), read_buffer.size());
+        file.open(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Can't open: " << filename << std::endl;
+            return false;
+        }
+
+        BoxRecordSax handler(on_record);
+        if (!nlohmann::json::sax_parse(file, &handler))
+        {
+            std::cerr << "Invalid box list: " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // 실패하면 records 를 비우고 false
+    static bool load_box_records(const std::string& filename, std::vector<BoxRecord>& records)
+    {
+        records.clear();
+        bool ok = stream_box_records(filename, [&](const BoxRecord& record) {
+            records.push_back(record);
+        });
+        if (!ok)
+        {
+            records.clear();
+        }
+        return ok;
+    }
+
+    static nlohmann::json box_records_to_json(const std::vector<BoxRecord>& records)
+    {
+        nlohmann::json boxes = nlohmann::json::array();
+        for (const auto& record : records)
+        {
+            nlohmann::json box = {
+                {"box_id", record.box_id},
+                {"box_size", record.box_size}
+            };
+            // 기존 목록 형식을 유지하도록 기본값은 쓰지 않는다
+            if (record.weight != 0.0f)
+                box["weight"] = record.weight;
+            if (record.flags != 0)
+                box["flags"] = record.flags;
+            boxes.push_back(box);
+        }
+        return boxes;
+    }
+
+    // JSON 박스 목록 <-> 바이너리 열 형식(BoxSetFile) 변환
+    static bool json_to_box_set(const std::string& json_filename, const std::string& box_set_filename)
+    {
+        std::vector<BoxRecord> records;
+        return load_box_records(json_filename, records) && BoxSetFile::write(box_set_filename, records);
+    }
+
+    static bool box_set_to_json(const std::string& box_set_filename, const std::string& json_filename)
+    {
+        BoxSetFile box_set(box_set_filename);
+        if (!box_set.is_open())
+        {
+            return false;
+        }
+        save_to_json(box_records_to_json(box_set.to_records()), json_filename);
+        return true;
+    }
 };
 
 #endif
\ No newline at end of file
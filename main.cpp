@@ -6,11 +6,17 @@
 #include <unordered_map>
 
 #include <nlohmann/json.hpp>
-#include "stacking_algorithm.hpp"
-#include "stackingVisualizer.hpp"
-
-int main()
+#include "stackingCore.hpp"
+#include "stackingVisualization.hpp"
+#include "jsonUtils.hpp"
+#include "boxGenerator.hpp"
+
+// usage: main [--metrics-only]
+// --metrics-only 면 애니메이션을 만들지 않고 지표만 출력한다
+int main(int argc, char** argv)
 {
+    bool render_animations = !(argc > 1 && std::string(argv[1]) == "--metrics-only");
+
     // 데이터 디렉토리 설정
     std::filesystem::path data_dir("sample_json");
     try {
@@ -35,354 +41,149 @@ int main()
     JsonUtils::save_to_json(boxes, boxes_path.string());
 */
     auto boxes_path = data_dir / "random_boxes.json";
-    auto loaded_boxes = JsonUtils::load_from_json(boxes_path.string());
-
-    // 적재 공간 크기 설정
-    std::vector<double> cubic_range = {1100, 1100, 1800};
-
-    // 박스 데이터 형식 변환
-    std::vector<std::unordered_map<std::string, std::string>> boxesMap;
-    for (const auto& box : loaded_boxes)
+    auto box_set_path = data_dir / "random_boxes.bin";
+
+    // JSON 보다 새로운 바이너리 박스 세트가 있으면 매핑해서 바로 쓰고,
+    // 없으면 JSON 을 DOM 없이 레코드로 읽은 뒤 다음 실행을 위해 바이너리로 저장한다
+    std::vector<BoxRecord> box_records;
+    std::error_code ec;
+    if (std::filesystem::exists(box_set_path, ec) &&
+        std::filesystem::last_write_time(box_set_path, ec) >= std::filesystem::last_write_time(boxes_path, ec))
     {
-        std::unordered_map<std::string, std::string> boxMap;
-        boxMap["box_id"] = std::to_string(box["box_id"].get<int>());
-        boxMap["box_size"] = box["box_size"].dump();
-        boxesMap.push_back(boxMap);
+        BoxSetFile box_set(box_set_path.string());
+        box_records = box_set.to_records();
     }
-
-    // 여러 적재 방식 테스트를 위한 함수
-    auto optmz_test_stacking_method = [&](StackingMethod method, const std::string& method_name) {
-        std::cout << "\nTesting " << method_name << "..." << std::endl;
-        
-        // 새로운 알고리즘 인스턴스 생성하여 독립성 보장
-        StackingAlgorithm fresh_algorithm(boxesMap, {
-            static_cast<int>(std::round(cubic_range[0])),
-            static_cast<int>(std::round(cubic_range[1])),
-            static_cast<int>(std::round(cubic_range[2]))
-        });
-        
-        // 적재 수행
-        std::vector<nlohmann::json> placements;
-        for (const auto& result : fresh_algorithm.Stack(method))
+    if (box_records.empty())
+    {
+        if (!JsonUtils::load_box_records(boxes_path.string(), box_records))
         {
-            nlohmann::json placement;
-            placement["box_id"] = std::stoi(result.box_id);
-            placement["box_loc"] = {
-                std::get<0>(result.box_loc), 
-                std::get<1>(result.box_loc), 
-                std::get<2>(result.box_loc)
-            };
-            placement["box_rot"] = result.box_rot;
-            placement["pallet_id"] = result.pallet_id;
-            placements.push_back(placement);
-        }
-
-        // 결과 저장
-        auto result_path = data_dir / (method_name + "_result.json");
-        JsonUtils::save_to_json(placements, result_path.string());
-
-        // 결과 시각화 디렉토리 생성
-        std::filesystem::path result_folder("results_" + method_name);
-        try {
-            if (std::filesystem::exists(result_folder))
-            {
-                std::filesystem::remove_all(result_folder);
-            }
-            std::filesystem::create_directories(result_folder);
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error creating result directory: " << e.what() << std::endl;
-            return;
-        }
-
-        std::filesystem::path result_folder2("2results_" + method_name);
-        try {
-            if (std::filesystem::exists(result_folder2))
-            {
-                std::filesystem::remove_all(result_folder2);
-            }
-            std::filesystem::create_directories(result_folder2);
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error creating result directory: " << e.what() << std::endl;
-            return;
+            std::cerr << "Can't read box list: " << boxes_path << std::endl;
+            return 1;
         }
+        BoxSetFile::write(box_set_path.string(), box_records);
+    }
+    // 시각화 검증용 JSON
+    auto loaded_boxes = JsonUtils::box_records_to_json(box_records);
 
-        std::filesystem::path result_folder_1600("1600_results_" + method_name);
-        try {
-            if (std::filesystem::exists(result_folder_1600))
-            {
-                std::filesystem::remove_all(result_folder_1600);
-            }
-            std::filesystem::create_directories(result_folder_1600);
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error creating result directory: " << e.what() << std::endl;
-            return;
-        }
+    // 적재 공간 크기 설정
+    std::vector<double> cubic_range = {1100, 1100, 1800};
+    std::vector<int> pallet_size = {
+        static_cast<int>(std::round(cubic_range[0])),
+        static_cast<int>(std::round(cubic_range[1])),
+        static_cast<int>(std::round(cubic_range[2]))
+    };
 
-        // 결과 시각화 및 검증
-        std::cout << "Starting visualization process for " << method_name << "..." << std::endl;
-        auto [stacking_rate, stacking_number] = StackingVisualizer::optimized_stack_check_and_visualize(
-            placements, 
-            loaded_boxes, 
-            cubic_range, 
-            result_folder.string(), 
-            method_name + "_animation"
-        );
+    // 반복 주문의 배치 계획 캐시
+    PlanCache plan_cache((data_dir / "plan_cache.bin").string(), StackingAlgorithm::PLANNER_REVISION);
 
-        StackingVisualizer::optimized_stack_check_and_visualize_1600(
-            placements, 
-            loaded_boxes, 
-            cubic_range, 
-            result_folder_1600.string(), 
-            method_name + "_animation"
-        );
+    // 적재 방식 하나를 실행해 결과를 저장하고, visualization 의 애니메이션을 그린 뒤 지표를 출력한다.
+    // record_stream 이면 배치가 결정된 순서 그대로의 기록으로 애니메이션을 그린다
+    // (최종 결과에는 버퍼에서 옮겨진 박스의 버퍼 기록이 남지 않는다)
+    auto test_stacking_method = [&](StackingMethod method, const std::string& method_name,
+                                    const VisualizationConfig& visualization, bool record_stream) {
+        std::cout << "\nTesting " << method_name << "..." << std::endl;
 
-        StackingVisualizer::optimized_stack_check_and_visualize_xyz(
-            placements, 
-            loaded_boxes, 
-            cubic_range, 
-            result_folder2.string(), 
-            method_name + "_animation"
-        );
+        // 새로운 알고리즘 인스턴스 생성하여 독립성 보장
+        StackingAlgorithm fresh_algorithm(box_records, pallet_size);
+        fresh_algorithm.set_plan_cache(&plan_cache);
+        fresh_algorithm.set_verbose(true);
 
-        // 통계 계산 및 출력
-        int main_count = 0, buffer_count = 0;
-        for (const auto& placement : placements) {
-            if (placement["pallet_id"].get<int>() == 1)
-            {
-                main_count++;
-            }
-            else if (placement["pallet_id"].get<int>() == 2)
-            {
-                buffer_count++;
-            }
+        std::vector<StackResult> placement_stream;
+        if (record_stream)
+        {
+            fresh_algorithm.set_result_sink([&](const StackResult& result) {
+                placement_stream.push_back(result);
+            });
         }
 
-        // 결과 출력
-        std::cout << "\n" << method_name << " Results:" << std::endl;
-        std::cout << "--------------------" << std::endl;
-        std::cout << "Main Pallet Boxes: " << main_count << std::endl;
-        std::cout << "Buffer Pallet Boxes: " << buffer_count << std::endl;
-        std::cout << "Stacking rate: " << stacking_rate << "%" << std::endl;
-        std::cout << "Number of stacked boxes: " << stacking_number << std::endl;
-        std::cout << "--------------------" << std::endl;
-    };
-
-    auto live_test_stacking_method = [&](StackingMethod method, const std::string& method_name) {
-        std::cout << "\nTesting " << method_name << "..." << std::endl;
-        
-        // 새로운 알고리즘 인스턴스 생성하여 독립성 보장
-        StackingAlgorithm fresh_algorithm(boxesMap, {
-            static_cast<int>(std::round(cubic_range[0])),
-            static_cast<int>(std::round(cubic_range[1])),
-            static_cast<int>(std::round(cubic_range[2]))
-        });
-        
         // 적재 수행
-        std::vector<nlohmann::json> placements;
-        for (const auto& result : fresh_algorithm.Stack(method))
-        {
-            nlohmann::json placement;
-            placement["box_id"] = std::stoi(result.box_id);
-            placement["box_loc"] = {
-                std::get<0>(result.box_loc), 
-                std::get<1>(result.box_loc), 
-                std::get<2>(result.box_loc)
-            };
-            placement["box_rot"] = result.box_rot;
-            placement["pallet_id"] = result.pallet_id;
-            placements.push_back(placement);
-        }
+        auto results = fresh_algorithm.Stack(method);
+        auto bounds = fresh_algorithm.evaluate_bounds(results);
 
-        // 결과 저장
+        // 결과 저장: DOM 을 거치지 않고 StackResult 에서 바로 쓴다
         auto result_path = data_dir / (method_name + "_result.json");
-        JsonUtils::save_to_json(placements, result_path.string());
-
-        // 결과 시각화 디렉토리 생성
-        std::filesystem::path result_folder("results_" + method_name);
-        try {
-            if (std::filesystem::exists(result_folder))
-            {
-                std::filesystem::remove_all(result_folder);
-            }
-            std::filesystem::create_directories(result_folder);
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error creating result directory: " << e.what() << std::endl;
-            return;
-        }
-
-        std::filesystem::path result_folder2("2results_" + method_name);
-        try {
-            if (std::filesystem::exists(result_folder2))
-            {
-                std::filesystem::remove_all(result_folder2);
-            }
-            std::filesystem::create_directories(result_folder2);
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error creating result directory: " << e.what() << std::endl;
-            return;
-        }
+        ResultWriter result_writer(result_path.string(), ResultFormat::JSON);
+        result_writer.write_all(results);
+        result_writer.close();
 
-        std::filesystem::path result_folder_1600("1600_results_" + method_name);
-        try {
-            if (std::filesystem::exists(result_folder_1600))
-            {
-                std::filesystem::remove_all(result_folder_1600);
-            }
-            std::filesystem::create_directories(result_folder_1600);
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error creating result directory: " << e.what() << std::endl;
-            return;
-        }
+        // 지표는 렌더링 없이 배치 결과에서 바로 계산한다
+        auto metrics = StackingEvaluator::evaluate(results, box_records, pallet_size);
 
         // 결과 시각화 및 검증
-        std::cout << "Starting visualization process for " << method_name << "..." << std::endl;
-        auto [stacking_rate, stacking_number] = StackingVisualizer::stack_all_box_check_and_visualize(
-            placements, 
-            loaded_boxes, 
-            cubic_range, 
-            result_folder.string(), 
-            method_name + "_animation"
-        );
-
-        StackingVisualizer::stack_all_box_check_and_visualize_1600(
-            placements, 
-            loaded_boxes, 
-            cubic_range, 
-            result_folder_1600.string(), 
-            method_name + "_animation"
-        );
-
-        StackingVisualizer::stack_all_box_check_and_visualize_xyz(
-            placements, 
-            loaded_boxes, 
-            cubic_range, 
-            result_folder2.string(), 
-            method_name + "_animation"
-        );
-
-        // 통계 계산 및 출력
-        int main_count = 0, buffer_count = 0;
-        for (const auto& placement : placements)
+        if (render_animations)
         {
-            if (placement["pallet_id"].get<int>() == 1)
+            std::cout << "Starting visualization process for " << method_name << "..." << std::endl;
+            std::vector<nlohmann::json> placements;
+            for (const auto& result : record_stream ? placement_stream : results)
             {
-                main_count++;
-            }
-            else if (placement["pallet_id"].get<int>() == 2)
-            {
-                buffer_count++;
+                nlohmann::json placement;
+                placement["box_id"] = std::stoi(result.box_id);
+                placement["box_loc"] = {
+                    std::get<0>(result.box_loc),
+                    std::get<1>(result.box_loc),
+                    std::get<2>(result.box_loc)
+                };
+                placement["box_rot"] = result.box_rot;
+                placement["pallet_id"] = result.pallet_id;
+                placement["from_pallet"] = result.from_pallet;
+                placements.push_back(placement);
             }
+            StackingVisualizer::visualize(placements, loaded_boxes, cubic_range, visualization);
         }
 
         // 결과 출력
         std::cout << "\n" << method_name << " Results:" << std::endl;
         std::cout << "--------------------" << std::endl;
-        std::cout << "Main Pallet Boxes: " << main_count << std::endl;
-        std::cout << "Buffer Pallet Boxes: " << buffer_count << std::endl;
-        std::cout << "Stacking rate: " << stacking_rate << "%" << std::endl;
-        std::cout << "Number of stacked boxes: " << stacking_number << std::endl;
+        std::cout << "Main Pallet Boxes: " << metrics.main_count << std::endl;
+        std::cout << "Buffer Pallet Boxes: " << metrics.buffer_count << " (moved to main: " << metrics.moved_count << ")" << std::endl;
+        std::cout << "Stacking rate: " << metrics.fill_rate << "%" << std::endl;
+        std::cout << "Number of stacked boxes: " << metrics.step_count << std::endl;
+        std::cout << "Max height: " << metrics.max_height << std::endl;
+        std::cout << "Center of gravity: (" << metrics.center_of_gravity[0] << ", " << metrics.center_of_gravity[1]
+                  << ", " << metrics.center_of_gravity[2] << ")" << std::endl;
+        std::cout << "Pallet lower bound (L1/L2): " << bounds.lower_bound_l1 << "/" << bounds.lower_bound_l2 << std::endl;
+        std::cout << "Optimality gap: " << bounds.optimality_gap * 100 << "%" << std::endl;
         std::cout << "--------------------" << std::endl;
     };
 
-    auto buffer_test_stacking_method = [&](StackingMethod method, const std::string& method_name) {
-        std::cout << "\nTesting " << method_name << "..." << std::endl;
-        
-        // 새로운 알고리즘 인스턴스 생성하여 독립성 보장
-        StackingAlgorithm fresh_algorithm(boxesMap, {
-            static_cast<int>(std::round(cubic_range[0])),
-            static_cast<int>(std::round(cubic_range[1])),
-            static_cast<int>(std::round(cubic_range[2]))
-        });
-        
-        // 적재 수행
-        std::vector<nlohmann::json> placements;
-        for (const auto& result : fresh_algorithm.Stack(method))
-        {
-            nlohmann::json placement;
-            placement["box_id"] = std::stoi(result.box_id);
-            placement["box_loc"] = {
-                std::get<0>(result.box_loc), 
-                std::get<1>(result.box_loc), 
-                std::get<2>(result.box_loc)
-            };
-            placement["box_rot"] = result.box_rot;
-            placement["pallet_id"] = result.pallet_id;
-            placements.push_back(placement);
-        }
-
-        // 결과 저장
-        auto result_path = data_dir / (method_name + "_result.json");
-        JsonUtils::save_to_json(placements, result_path.string());
-
-        // 결과 시각화 디렉토리 생성
-        std::filesystem::path result_folder("results_" + method_name);
-        try {
-            if (std::filesystem::exists(result_folder))
-            {
-                std::filesystem::remove_all(result_folder);
-            }
-            std::filesystem::create_directories(result_folder);
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error creating result directory: " << e.what() << std::endl;
-            return;
-        }
-
-        std::filesystem::path result_folder2("2results_" + method_name);
-        try {
-            if (std::filesystem::exists(result_folder2))
-            {
-                std::filesystem::remove_all(result_folder2);
-            }
-            std::filesystem::create_directories(result_folder2);
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error creating result directory: " << e.what() << std::endl;
-            return;
-        }
-
-        // 결과 시각화 및 검증
-        std::cout << "Starting visualization process for " << method_name << "..." << std::endl;
-        auto [stacking_rate, stacking_number] = StackingVisualizer::stack_with_buffer_check_and_visualize(
-            placements, 
-            loaded_boxes, 
-            cubic_range, 
-            result_folder.string(), 
-            method_name + "_animation"
-        );
-
-        StackingVisualizer::stack_with_buffer_check_and_visualize_xyz(
-            placements, 
-            loaded_boxes, 
-            cubic_range, 
-            result_folder2.string(), 
-            method_name + "_animation"
-        );
-
-        // 통계 계산 및 출력
-        int main_count = 0, buffer_count = 0;
-        for (const auto& placement : placements) {
-            if (placement["pallet_id"].get<int>() == 1)
-            {
-                main_count++;
-            } else if (placement["pallet_id"].get<int>() == 2)
-            {
-                buffer_count++;
-            }
-        }
+    // 메인 팔렛트만 쓰는 방식의 애니메이션: 두 시점, 두 팔렛트, 정면/평면.
+    // 프레임 상태는 한 번만 만들고 모든 애니메이션을 같은 렌더링 루프에서 그린다
+    auto main_pallet_visualization = [](const std::string& method_name, const std::string& label,
+                                        const std::string& rate_graph_file) {
+        VisualizationConfig visualization;
+        visualization.outputs.push_back(StackingVisualizer::main_pallet_output(
+            "results_" + method_name, method_name + "_animation", label));
+        visualization.outputs.back().rate_graph_file = rate_graph_file;
+        visualization.outputs.push_back(StackingVisualizer::both_pallets_output(
+            "1600_results_" + method_name, method_name + "_animation", label));
+        visualization.outputs.push_back(StackingVisualizer::main_pallet_xyz_output(
+            "2results_" + method_name, method_name + "_animation", label));
+        return visualization;
+    };
 
-        // 결과 출력
-        std::cout << "\n" << method_name << " Results:" << std::endl;
-        std::cout << "--------------------" << std::endl;
-        std::cout << "Main Pallet Boxes: " << main_count << std::endl;
-        std::cout << "Buffer Pallet Boxes: " << buffer_count << std::endl;
-        std::cout << "Stacking rate: " << stacking_rate << "%" << std::endl;
-        std::cout << "Number of stacked boxes: " << stacking_number << std::endl;
-        std::cout << "--------------------" << std::endl;
+    // 버퍼를 쓰는 방식의 애니메이션: 두 팔렛트와 메인 팔렛트 정면/평면. 버퍼에서 옮겨지는 박스는 따로 한 프레임을 둔다
+    auto buffer_visualization = [](const std::string& method_name) {
+        VisualizationConfig visualization;
+        visualization.outputs.push_back(StackingVisualizer::both_pallets_output(
+            "results_" + method_name, method_name + "_animation", "Stack with Buffer"));
+        visualization.outputs.back().rate_graph_file = "stacking_rate_graph_buf.png";
+        visualization.outputs.push_back(StackingVisualizer::main_pallet_xyz_output(
+            "2results_" + method_name, method_name + "_animation", "Stacking with Buffer"));
+        visualization.show_move_source = true;
+        return visualization;
     };
 
     // 여러 적재 방식 테스트
-    optmz_test_stacking_method(StackingMethod::OPTIMIZED_STACK, "optimized_stack");
-    buffer_test_stacking_method(StackingMethod::STACK_WITH_BUFFER, "stack_with_buffer");
-    live_test_stacking_method(StackingMethod::PALLET_STACK_ALL, "stack_all_boxes");
+    test_stacking_method(StackingMethod::OPTIMIZED_STACK, "optimized_stack",
+                         main_pallet_visualization("optimized_stack", "Stack Optimized", "stacking_rate_graph_optmz.png"), false);
+    test_stacking_method(StackingMethod::LAYERED, "layered_stack",
+                         main_pallet_visualization("layered_stack", "Stack Layered", "stacking_rate_graph_layered.png"), false);
+    test_stacking_method(StackingMethod::STACK_WITH_BUFFER, "stack_with_buffer",
+                         buffer_visualization("stack_with_buffer"), true);
+    test_stacking_method(StackingMethod::PALLET_STACK_ALL, "stack_all_boxes",
+                         main_pallet_visualization("stack_all_boxes", "Stack all Boxes", "stacking_rate_graph_live.png"), false);
+
+    plan_cache.flush();
 
     return 0;
 }
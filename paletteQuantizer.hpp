@@ -0,0 +1,292 @@
+#ifndef _PALETTE_QUANTIZER
+#define _PALETTE_QUANTIZER
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+
+#include <opencv2/opencv.hpp>
+
+// BGR 프레임 -> 256 색 팔레트 인덱스.
+// fixed() 는 기존 3-3-2 팔레트로, 채널마다 256 칸 표에서 비트 조각을 꺼내 OR 한다 (픽셀당 나눗셈 없음).
+// adaptive() 는 샘플 프레임에서 median cut 으로 팔레트를 만들고, 5-5-5 RGB -> 인덱스 표를 한 번 계산해 둔다.
+// 애니메이션마다 한 번 만들어 두고 모든 프레임에 쓰며, 행 묶음 단위로 cv::parallel_for_ 에서 돌린다.
+// 인덱스 하나는 GIF 투명 픽셀용으로 비워 두고 그 색으로는 변환하지 않는다
+class PaletteQuantizer {
+public:
+    struct Color {
+        uint8_t red;
+        uint8_t green;
+        uint8_t blue;
+    };
+
+    static PaletteQuantizer fixed()
+    {
+        PaletteQuantizer quantizer;
+        quantizer.adaptive_palette = false;
+        quantizer.colors.resize(256);
+        for (int i = 0; i < 256; i++)
+        {
+            quantizer.colors[i] = {
+                static_cast<uint8_t>(((i >> 5) & 0x07) * 255 / 7),
+                static_cast<uint8_t>(((i >> 2) & 0x07) * 255 / 7),
+                static_cast<uint8_t>((i & 0x03) * 255 / 3)
+            };
+        }
+        // (0, 0, 85). 렌더링 결과에 거의 나오지 않는 색이라 투명 인덱스로 빼고 검정으로 보낸다
+        quantizer.transparent = 1;
+
+        for (int v = 0; v < 256; v++)
+        {
+            quantizer.blue_bits[v] = static_cast<uint8_t>(v * 3 / 255);
+            quantizer.green_bits[v] = static_cast<uint8_t>((v * 7 / 255) << 2);
+            quantizer.red_bits[v] = static_cast<uint8_t>((v * 7 / 255) << 5);
+        }
+        return quantizer;
+    }
+
+    // sample (BGR) 의 색 분포로 팔레트를 만든다. 마지막 인덱스는 투명용으로 남긴다
+    static PaletteQuantizer adaptive(const cv::Mat& sample, int max_colors = 255)
+    {
+        PaletteQuantizer quantizer;
+        quantizer.adaptive_palette = true;
+        max_colors = std::clamp(max_colors, 1, 255);
+
+        // 5-5-5 히스토그램. 칸마다 실제 색의 합도 모아서 팔레트 색을 평균으로 정한다
+        std::vector<Bin> bins(TABLE_SIZE);
+        for (int y = 0; y < sample.rows; y++)
+        {
+            const uint8_t* row = sample.ptr<uint8_t>(y);
+            for (int x = 0; x < sample.cols; x++)
+            {
+                Bin& bin = bins[table_index(row[3 * x], row[3 * x + 1], row[3 * x + 2])];
+                bin.count++;
+                bin.sum[0] += row[3 * x + 2];
+                bin.sum[1] += row[3 * x + 1];
+                bin.sum[2] += row[3 * x];
+            }
+        }
+
+        std::vector<uint32_t> used;
+        for (uint32_t i = 0; i < TABLE_SIZE; i++)
+        {
+            if (bins[i].count > 0)
+                used.push_back(i);
+        }
+        if (used.empty())
+            return fixed();
+
+        quantizer.colors = median_cut(bins, used, max_colors);
+        quantizer.transparent = static_cast<int>(quantizer.colors.size());
+        quantizer.colors.resize(256, Color{0, 0, 0});
+        quantizer.build_table();
+        return quantizer;
+    }
+
+    // 256 칸 팔레트 (RGB). 쓰지 않는 칸은 검정
+    const std::vector<Color>& palette() const { return colors; }
+    int transparent_index() const { return transparent; }
+    bool is_adaptive() const { return adaptive_palette; }
+
+    // BGR 픽셀을 out (width 간격) 에 인덱스로 쓴다
+    void quantize(const uint8_t* pixels, int width, int height, size_t stride, uint8_t* out) const
+    {
+        cv::parallel_for_(cv::Range(0, (height + BAND_ROWS - 1) / BAND_ROWS), [&](const cv::Range& bands) {
+            for (int band = bands.start; band < bands.end; band++)
+            {
+                int first = band * BAND_ROWS;
+                int rows = std::min(BAND_ROWS, height - first);
+                const uint8_t* source = pixels + first * stride;
+                uint8_t* target = out + static_cast<size_t>(first) * width;
+                if (adaptive_palette)
+                    quantize_table(source, width, rows, stride, target);
+                else
+                    quantize_fixed(source, width, rows, stride, target);
+            }
+        });
+    }
+
+private:
+    static constexpr int BAND_ROWS = 64;
+    static constexpr uint32_t TABLE_SIZE = 1u << 15;
+
+    struct Bin {
+        uint32_t count = 0;
+        std::array<uint64_t, 3> sum = {0, 0, 0};     // R, G, B
+    };
+
+    bool adaptive_palette = false;
+    std::vector<Color> colors;
+    int transparent = 0;
+
+    // fixed: 채널 값 -> 3-3-2 인덱스의 비트 조각
+    std::array<uint8_t, 256> blue_bits = {};
+    std::array<uint8_t, 256> green_bits = {};
+    std::array<uint8_t, 256> red_bits = {};
+
+    // adaptive: 5-5-5 RGB -> 팔레트 인덱스
+    std::vector<uint8_t> table;
+
+    static uint32_t table_index(uint8_t blue, uint8_t green, uint8_t red)
+    {
+        return (static_cast<uint32_t>(red >> 3) << 10) | (static_cast<uint32_t>(green >> 3) << 5) | (blue >> 3);
+    }
+
+    void quantize_fixed(const uint8_t* pixels, int width, int rows, size_t stride, uint8_t* out) const
+    {
+        const uint8_t reserved = static_cast<uint8_t>(transparent);
+        for (int y = 0; y < rows; y++)
+        {
+            const uint8_t* row = pixels + y * stride;
+            uint8_t* out_row = out + static_cast<size_t>(y) * width;
+            for (int x = 0; x < width; x++)
+            {
+                uint8_t index = red_bits[row[3 * x + 2]] | green_bits[row[3 * x + 1]] | blue_bits[row[3 * x]];
+                out_row[x] = index == reserved ? 0 : index;
+            }
+        }
+    }
+
+    void quantize_table(const uint8_t* pixels, int width, int rows, size_t stride, uint8_t* out) const
+    {
+        for (int y = 0; y < rows; y++)
+        {
+            const uint8_t* row = pixels + y * stride;
+            uint8_t* out_row = out + static_cast<size_t>(y) * width;
+            for (int x = 0; x < width; x++)
+            {
+                out_row[x] = table[table_index(row[3 * x], row[3 * x + 1], row[3 * x + 2])];
+            }
+        }
+    }
+
+    // 픽셀 수가 많고 색 범위가 넓은 상자부터 가장 넓은 축의 중앙값에서 자른다
+    static std::vector<Color> median_cut(const std::vector<Bin>& bins, std::vector<uint32_t>& used, int max_colors)
+    {
+        struct Box {
+            size_t begin;
+            size_t end;
+            uint64_t count;
+            int axis;
+            int range;
+        };
+
+        auto component = [](uint32_t index, int axis) {
+            return static_cast<int>((index >> (10 - 5 * axis)) & 0x1F);     // 0 = R, 1 = G, 2 = B
+        };
+        auto measure = [&](Box& box) {
+            int low[3] = {31, 31, 31};
+            int high[3] = {0, 0, 0};
+            box.count = 0;
+            for (size_t i = box.begin; i < box.end; i++)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    low[axis] = std::min(low[axis], component(used[i], axis));
+                    high[axis] = std::max(high[axis], component(used[i], axis));
+                }
+                box.count += bins[used[i]].count;
+            }
+            box.axis = 0;
+            for (int axis = 1; axis < 3; axis++)
+            {
+                if (high[axis] - low[axis] > high[box.axis] - low[box.axis])
+                    box.axis = axis;
+            }
+            box.range = high[box.axis] - low[box.axis];
+        };
+
+        std::vector<Box> boxes(1);
+        boxes[0] = {0, used.size(), 0, 0, 0};
+        measure(boxes[0]);
+        while (static_cast<int>(boxes.size()) < max_colors)
+        {
+            auto it = std::max_element(boxes.begin(), boxes.end(), [](const Box& a, const Box& b) {
+                return (a.end - a.begin > 1 ? a.count * (a.range + 1) : 0) < (b.end - b.begin > 1 ? b.count * (b.range + 1) : 0);
+            });
+            if (it->end - it->begin <= 1)
+                break;
+
+            Box box = *it;
+            std::sort(used.begin() + box.begin, used.begin() + box.end, [&](uint32_t a, uint32_t b) {
+                return component(a, box.axis) < component(b, box.axis);
+            });
+            // 픽셀 수 기준 중앙값. 양쪽이 비지 않게 한다
+            uint64_t half = 0;
+            size_t split = box.begin;
+            while (split < box.end - 1 && half + bins[used[split]].count <= box.count / 2)
+            {
+                half += bins[used[split]].count;
+                split++;
+            }
+            split = std::clamp(split, box.begin + 1, box.end - 1);
+
+            Box upper = {split, box.end, 0, 0, 0};
+            it->end = split;
+            measure(*it);
+            measure(upper);
+            boxes.push_back(upper);
+        }
+
+        std::vector<Color> palette;
+        palette.reserve(boxes.size());
+        for (const auto& box : boxes)
+        {
+            std::array<uint64_t, 3> sum = {0, 0, 0};
+            uint64_t count = 0;
+            for (size_t i = box.begin; i < box.end; i++)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    sum[axis] += bins[used[i]].sum[axis];
+                }
+                count += bins[used[i]].count;
+            }
+            count = std::max<uint64_t>(count, 1);
+            palette.push_back({
+                static_cast<uint8_t>((sum[0] + count / 2) / count),
+                static_cast<uint8_t>((sum[1] + count / 2) / count),
+                static_cast<uint8_t>((sum[2] + count / 2) / count)
+            });
+        }
+        return palette;
+    }
+
+    // 5-5-5 칸의 중심색마다 가장 가까운 팔레트 색
+    void build_table()
+    {
+        table.resize(TABLE_SIZE);
+        cv::parallel_for_(cv::Range(0, 32), [&](const cv::Range& reds) {
+            for (int red = reds.start; red < reds.end; red++)
+            {
+                for (uint32_t rest = 0; rest < (1u << 10); rest++)
+                {
+                    uint32_t index = (static_cast<uint32_t>(red) << 10) | rest;
+                    int r = (red << 3) | 4;
+                    int g = (((index >> 5) & 0x1F) << 3) | 4;
+                    int b = ((index & 0x1F) << 3) | 4;
+
+                    int best = 0;
+                    int best_distance = std::numeric_limits<int>::max();
+                    for (int i = 0; i < transparent; i++)
+                    {
+                        int dr = r - colors[i].red;
+                        int dg = g - colors[i].green;
+                        int db = b - colors[i].blue;
+                        int distance = 2 * dr * dr + 4 * dg * dg + 3 * db * db;
+                        if (distance < best_distance)
+                        {
+                            best_distance = distance;
+                            best = i;
+                        }
+                    }
+                    table[index] = static_cast<uint8_t>(best);
+                }
+            }
+        });
+    }
+};
+
+#endif
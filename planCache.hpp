@@ -0,0 +1,321 @@
+#ifndef _PLAN_CACHE
+#define _PLAN_CACHE
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// 캐시에 저장되는 배치 하나. box id 대신 정규화된 순서의 slot 번호를 저장한다.
+struct PlanEntry {
+    uint32_t slot;
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    int32_t rot;
+    // 예전 i32 pallet_id 자리를 둘로 나눴다 (파일 버전 2)
+    int16_t pallet_id;
+    int16_t from_pallet;
+};
+
+// 주문 서명: (박스 치수 목록, 팔레트 크기, 간격, 방식)
+// order[slot] 은 정규화된 slot 에 해당하는 원래 박스 인덱스
+struct PlanKey {
+    uint64_t hash = 0;
+    std::vector<int32_t> signature;
+    std::vector<size_t> order;
+};
+
+// Placement plan cache persisted on disk.
+// File layout: "PLNCACHE" magic, u32 version, u32 planner_revision, then records of
+// [u64 hash][u32 signature_len][u32 entry_count][i32 signature...][PlanEntry...]
+// version 이나 planner_revision 이 다른 파일은 <파일명>.old 로 옮겨 두고 새 파일을 시작한다
+// lookup 은 공유 잠금, store/flush 는 배타 잠금을 쓰므로 여러 스레드가 한 캐시를 함께 쓸 수 있다
+class PlanCache {
+public:
+    // planner_revision 은 배치 알고리즘의 revision (StackingAlgorithm::PLANNER_REVISION)
+    PlanCache(const std::string& filename, uint32_t planner_revision)
+        : filename(filename), planner_revision(planner_revision)
+    {
+        load();
+    }
+
+    ~PlanCache()
+    {
+        unmap();
+    }
+
+    PlanCache(const PlanCache&) = delete;
+    PlanCache& operator=(const PlanCache&) = delete;
+
+    // order_sensitive 가 false 이면 같은 치수 구성의 주문은 입력 순서와 관계없이 같은 키가 된다
+    static PlanKey make_key(const std::vector<std::vector<int>>& box_dims,
+                            const std::vector<int>& pallet_size,
+                            int gap,
+                            int method,
+                            bool order_sensitive)
+    {
+        PlanKey key;
+        key.order.resize(box_dims.size());
+        std::iota(key.order.begin(), key.order.end(), 0);
+        if (!order_sensitive)
+        {
+            std::stable_sort(key.order.begin(), key.order.end(),
+                [&](size_t a, size_t b) { return box_dims[a] < box_dims[b]; });
+        }
+
+        key.signature.reserve(6 + box_dims.size() * 3);
+        key.signature.push_back(method);
+        key.signature.push_back(gap);
+        key.signature.push_back(pallet_size[0]);
+        key.signature.push_back(pallet_size[1]);
+        key.signature.push_back(pallet_size[2]);
+        key.signature.push_back(static_cast<int32_t>(box_dims.size()));
+        for (size_t idx : key.order)
+        {
+            for (int d = 0; d < 3; d++)
+            {
+                key.signature.push_back(box_dims[idx][d]);
+            }
+        }
+
+        // FNV-1a 64
+        uint64_t hash = 1469598103934665603ULL;
+        const auto* bytes = reinterpret_cast<const unsigned char*>(key.signature.data());
+        for (size_t i = 0; i < key.signature.size() * sizeof(int32_t); i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        key.hash = hash;
+        return key;
+    }
+
+    bool lookup(const PlanKey& key, std::vector<PlanEntry>& entries) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return lookup_locked(key, entries);
+    }
+
+    void store(const PlanKey& key, const std::vector<PlanEntry>& entries)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        std::vector<PlanEntry> existing;
+        if (lookup_locked(key, existing))
+        {
+            return;
+        }
+        added.emplace(key.hash, Record{key.signature, entries, false});
+    }
+
+    // 새로 추가된 계획을 파일 끝에 덧붙인다
+    bool flush()
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        bool write_header = !std::filesystem::exists(filename) || std::filesystem::file_size(filename) == 0;
+        // 다른 형식의 파일 뒤에 덧붙이면 읽을 수 없는 파일이 되므로 건드리지 않는다
+        if (!write_header && !header_valid)
+        {
+            std::cerr << "Not writing to invalid plan cache: " << filename << std::endl;
+            return false;
+        }
+        std::ofstream file(filename, std::ios::binary | std::ios::app);
+        if (!file.is_open())
+        {
+            std::cerr << "Can't open: " << filename << std::endl;
+            return false;
+        }
+
+        if (write_header)
+        {
+            uint32_t version = VERSION;
+            file.write(MAGIC, 8);
+            file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+            file.write(reinterpret_cast<const char*>(&planner_revision), sizeof(planner_revision));
+        }
+
+        for (auto& [hash, record] : added)
+        {
+            if (record.persisted)
+                continue;
+
+            uint32_t signature_len = static_cast<uint32_t>(record.signature.size());
+            uint32_t entry_count = static_cast<uint32_t>(record.entries.size());
+            file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+            file.write(reinterpret_cast<const char*>(&signature_len), sizeof(signature_len));
+            file.write(reinterpret_cast<const char*>(&entry_count), sizeof(entry_count));
+            file.write(reinterpret_cast<const char*>(record.signature.data()), signature_len * sizeof(int32_t));
+            file.write(reinterpret_cast<const char*>(record.entries.data()), entry_count * sizeof(PlanEntry));
+            record.persisted = true;
+        }
+        return static_cast<bool>(file);
+    }
+
+    size_t size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return mapped_index.size() + added.size();
+    }
+
+private:
+    static constexpr const char* MAGIC = "PLNCACHE";
+    // 2: PlanEntry 에 from_pallet 추가
+    static constexpr uint32_t VERSION = 2;
+    static constexpr size_t HEADER_SIZE = 16;
+
+    struct Record {
+        std::vector<int32_t> signature;
+        std::vector<PlanEntry> entries;
+        bool persisted;
+    };
+
+    std::string filename;
+    uint32_t planner_revision;
+    const char* mapped_data = nullptr;
+    size_t mapped_size = 0;
+    std::vector<char> fallback_data;
+    std::unordered_multimap<uint64_t, size_t> mapped_index;
+    std::unordered_multimap<uint64_t, Record> added;
+    bool header_valid = true;
+    mutable std::shared_mutex mutex;
+
+    // 호출하는 쪽이 잠금을 잡고 있어야 한다. 이번 실행에서 추가된 계획을 먼저 찾는다
+    bool lookup_locked(const PlanKey& key, std::vector<PlanEntry>& entries) const
+    {
+        auto added_range = added.equal_range(key.hash);
+        for (auto it = added_range.first; it != added_range.second; ++it)
+        {
+            if (it->second.signature == key.signature)
+            {
+                entries = it->second.entries;
+                return true;
+            }
+        }
+
+        auto mapped_range = mapped_index.equal_range(key.hash);
+        for (auto it = mapped_range.first; it != mapped_range.second; ++it)
+        {
+            const char* record = mapped_data + it->second;
+            uint32_t signature_len, entry_count;
+            std::memcpy(&signature_len, record + 8, sizeof(uint32_t));
+            std::memcpy(&entry_count, record + 12, sizeof(uint32_t));
+            if (signature_len != key.signature.size() ||
+                std::memcmp(record + 16, key.signature.data(), signature_len * sizeof(int32_t)) != 0)
+            {
+                continue;
+            }
+
+            entries.resize(entry_count);
+            std::memcpy(entries.data(), record + 16 + signature_len * sizeof(int32_t), entry_count * sizeof(PlanEntry));
+            return true;
+        }
+        return false;
+    }
+
+    void load()
+    {
+        std::error_code ec;
+        if (!std::filesystem::exists(filename, ec))
+            return;
+
+#ifndef _WIN32
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                mapped_data = static_cast<const char*>(addr);
+                mapped_size = static_cast<size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+#else
+        std::ifstream file(filename, std::ios::binary);
+        fallback_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        mapped_data = fallback_data.data();
+        mapped_size = fallback_data.size();
+#endif
+
+        if (mapped_size < HEADER_SIZE || std::memcmp(mapped_data, MAGIC, 8) != 0)
+        {
+            std::cerr << "Invalid plan cache: " << filename << std::endl;
+            header_valid = false;
+            unmap();
+            return;
+        }
+
+        // 형식이나 배치 알고리즘이 바뀐 캐시는 더 이상 맞지 않으므로 옮겨 두고 새로 쓴다
+        uint32_t version, revision;
+        std::memcpy(&version, mapped_data + 8, sizeof(version));
+        std::memcpy(&revision, mapped_data + 12, sizeof(revision));
+        if (version != VERSION || revision != planner_revision)
+        {
+            std::cerr << "Outdated plan cache (version " << version << ", planner revision " << revision
+                      << "), starting a new one: " << filename << std::endl;
+            unmap();
+            std::filesystem::rename(filename, filename + ".old", ec);
+            if (ec)
+            {
+                std::cerr << "Can't rotate plan cache: " << ec.message() << std::endl;
+                header_valid = false;
+            }
+            return;
+        }
+
+        // 레코드 헤더만 훑어서 색인을 만든다. 배치 데이터는 조회 시점에 매핑된 영역에서 읽는다
+        size_t offset = HEADER_SIZE;
+        while (offset + 16 <= mapped_size)
+        {
+            uint64_t hash;
+            uint32_t signature_len, entry_count;
+            std::memcpy(&hash, mapped_data + offset, sizeof(hash));
+            std::memcpy(&signature_len, mapped_data + offset + 8, sizeof(uint32_t));
+            std::memcpy(&entry_count, mapped_data + offset + 12, sizeof(uint32_t));
+
+            size_t record_size = 16 + static_cast<size_t>(signature_len) * sizeof(int32_t) +
+                                 static_cast<size_t>(entry_count) * sizeof(PlanEntry);
+            if (offset + record_size > mapped_size)
+            {
+                std::cerr << "Truncated plan cache record at offset " << offset << std::endl;
+                break;
+            }
+            mapped_index.emplace(hash, offset);
+            offset += record_size;
+        }
+    }
+
+    void unmap()
+    {
+#ifndef _WIN32
+        if (mapped_data)
+        {
+            ::munmap(const_cast<char*>(mapped_data), mapped_size);
+        }
+#endif
+        fallback_data.clear();
+        mapped_data = nullptr;
+        mapped_size = 0;
+        mapped_index.clear();
+    }
+};
+
+#endif
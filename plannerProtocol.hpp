@@ -0,0 +1,268 @@
+#ifndef _PLANNER_PROTOCOL
+#define _PLANNER_PROTOCOL
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <charconv>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "boxRecord.hpp"
+#include "stackResult.hpp"
+
+// Planner daemon wire protocol (Unix domain socket, little endian).
+// Frame:    u32 magic 'PLNR', u16 version, u16 type, u32 payload_len, payload
+// Request:  u32 method, i32 pallet[3], i32 gap, u32 box_count, box_count x (i32 id, x, y, z)
+// Response: u32 status, u32 count, u64 plan_ns, count x (i32 box_id, x, y, z, rot, pallet_id, from_pallet)
+// 한 연결에서 요청/응답을 여러 번 주고받을 수 있다. plan_ns 는 서버에서 계획에 걸린 시간
+namespace PlannerProtocol {
+
+constexpr uint32_t MAGIC = 0x524E4C50;    // "PLNR"
+constexpr uint16_t VERSION = 2;     // 2: WireResult 에 from_pallet 추가
+constexpr uint32_t MAX_PAYLOAD = 64u << 20;
+
+enum class FrameType : uint16_t {
+    PLAN_REQUEST = 1,
+    PLAN_RESPONSE = 2
+};
+
+enum class Status : uint32_t {
+    OK = 0,
+    BAD_REQUEST = 1,
+    PLAN_FAILED = 2
+};
+
+struct FrameHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t type;
+    uint32_t payload_len;
+};
+static_assert(sizeof(FrameHeader) == 12, "frame header must stay 12 bytes");
+
+struct RequestHeader {
+    uint32_t method;
+    int32_t pallet[3];
+    int32_t gap;
+    uint32_t box_count;
+};
+
+struct WireBox {
+    int32_t id;
+    int32_t size[3];
+};
+
+struct ResponseHeader {
+    uint32_t status;
+    uint32_t count;
+    uint64_t plan_ns;
+};
+
+struct WireResult {
+    int32_t box_id;
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    int32_t rot;
+    int32_t pallet_id;
+    int32_t from_pallet;    // StackResult::from_pallet
+};
+
+struct PlanRequest {
+    uint32_t method = 0;
+    std::vector<int> pallet_size;
+    int gap = 0;
+    std::vector<BoxRecord> boxes;
+};
+
+struct PlanResponse {
+    Status status = Status::OK;
+    uint64_t plan_ns = 0;
+    std::vector<StackResult> results;
+};
+
+// EINTR 와 부분 전송을 처리하며 정확히 bytes 만큼 읽고 쓴다. 연결이 끊기면 false
+inline bool read_full(int fd, void* data, size_t bytes)
+{
+    auto* out = static_cast<char*>(data);
+    while (bytes > 0)
+    {
+        ssize_t n = ::read(fd, out, bytes);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        out += n;
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline bool write_full(int fd, const void* data, size_t bytes)
+{
+    const auto* in = static_cast<const char*>(data);
+    while (bytes > 0)
+    {
+        ssize_t n = ::send(fd, in, bytes, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        in += n;
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+template <typename T>
+void append(std::vector<char>& buffer, const T& value)
+{
+    const auto* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+// 프레임 헤더 자리를 비워 두고 payload 를 쌓은 뒤 finish_frame 으로 길이를 채운다.
+// 헤더와 payload 를 한 번의 send 로 보내기 위함
+inline void begin_frame(std::vector<char>& frame)
+{
+    frame.assign(sizeof(FrameHeader), 0);
+}
+
+inline void finish_frame(std::vector<char>& frame, FrameType type)
+{
+    FrameHeader header{MAGIC, VERSION, static_cast<uint16_t>(type),
+                       static_cast<uint32_t>(frame.size() - sizeof(FrameHeader))};
+    std::memcpy(frame.data(), &header, sizeof(header));
+}
+
+// 프레임 하나를 읽어 payload 를 돌려준다. payload 버퍼는 호출하는 쪽이 재사용한다
+inline bool recv_frame(int fd, FrameType& type, std::vector<char>& payload)
+{
+    FrameHeader header;
+    if (!read_full(fd, &header, sizeof(header)))
+        return false;
+    if (header.magic != MAGIC || header.version != VERSION || header.payload_len > MAX_PAYLOAD)
+    {
+        std::cerr << "Invalid planner frame" << std::endl;
+        return false;
+    }
+    type = static_cast<FrameType>(header.type);
+    payload.resize(header.payload_len);
+    return read_full(fd, payload.data(), payload.size());
+}
+
+inline void encode_request(std::vector<char>& frame, const PlanRequest& request)
+{
+    begin_frame(frame);
+    frame.reserve(sizeof(FrameHeader) + sizeof(RequestHeader) + request.boxes.size() * sizeof(WireBox));
+    RequestHeader header{
+        request.method,
+        {request.pallet_size[0], request.pallet_size[1], request.pallet_size[2]},
+        request.gap,
+        static_cast<uint32_t>(request.boxes.size())
+    };
+    append(frame, header);
+    for (const auto& box : request.boxes)
+    {
+        append(frame, WireBox{box.box_id, {box.box_size[0], box.box_size[1], box.box_size[2]}});
+    }
+    finish_frame(frame, FrameType::PLAN_REQUEST);
+}
+
+inline bool decode_request(const std::vector<char>& payload, PlanRequest& request)
+{
+    RequestHeader header;
+    if (payload.size() < sizeof(header))
+        return false;
+    std::memcpy(&header, payload.data(), sizeof(header));
+    if (payload.size() != sizeof(header) + static_cast<size_t>(header.box_count) * sizeof(WireBox))
+        return false;
+
+    request.method = header.method;
+    request.pallet_size.assign(header.pallet, header.pallet + 3);
+    request.gap = header.gap;
+    request.boxes.resize(header.box_count);
+    const char* cursor = payload.data() + sizeof(header);
+    for (auto& box : request.boxes)
+    {
+        WireBox wire;
+        std::memcpy(&wire, cursor, sizeof(wire));
+        cursor += sizeof(wire);
+        box.box_id = wire.id;
+        box.box_size = {wire.size[0], wire.size[1], wire.size[2]};
+    }
+    return true;
+}
+
+inline void encode_response(std::vector<char>& frame, Status status, uint64_t plan_ns,
+                            const std::vector<StackResult>& results)
+{
+    begin_frame(frame);
+    frame.reserve(sizeof(FrameHeader) + sizeof(ResponseHeader) + results.size() * sizeof(WireResult));
+    append(frame, ResponseHeader{static_cast<uint32_t>(status), static_cast<uint32_t>(results.size()), plan_ns});
+    for (const auto& result : results)
+    {
+        // 요청 id 가 정수이므로 결과 id 도 항상 정수 문자열이다
+        int32_t box_id = -1;
+        std::from_chars(result.box_id.data(), result.box_id.data() + result.box_id.size(), box_id);
+        append(frame, WireResult{
+            box_id,
+            std::get<0>(result.box_loc),
+            std::get<1>(result.box_loc),
+            std::get<2>(result.box_loc),
+            result.box_rot,
+            result.pallet_id,
+            result.from_pallet
+        });
+    }
+    finish_frame(frame, FrameType::PLAN_RESPONSE);
+}
+
+inline bool decode_response(const std::vector<char>& payload, PlanResponse& response)
+{
+    ResponseHeader header;
+    if (payload.size() < sizeof(header))
+        return false;
+    std::memcpy(&header, payload.data(), sizeof(header));
+    if (payload.size() != sizeof(header) + static_cast<size_t>(header.count) * sizeof(WireResult))
+        return false;
+
+    response.status = static_cast<Status>(header.status);
+    response.plan_ns = header.plan_ns;
+    response.results.resize(header.count);
+    const char* cursor = payload.data() + sizeof(header);
+    for (auto& result : response.results)
+    {
+        WireResult wire;
+        std::memcpy(&wire, cursor, sizeof(wire));
+        cursor += sizeof(wire);
+        result = {std::to_string(wire.box_id), std::make_tuple(wire.x, wire.y, wire.z), wire.rot, wire.pallet_id,
+                  wire.from_pallet};
+    }
+    return true;
+}
+
+// 소켓 경로가 sockaddr_un 에 들어가지 않으면 false
+inline bool make_address(const std::string& socket_path, sockaddr_un& address)
+{
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Socket path too long: " << socket_path << std::endl;
+        return false;
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    return true;
+}
+
+} // namespace PlannerProtocol
+
+#endif
@@ -0,0 +1,219 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "stackingCore.hpp"
+#include "jsonUtils.hpp"
+#include "plannerProtocol.hpp"
+
+// planner_daemon 시험용 클라이언트. 주문 하나를 repeat 번 보내고 왕복 시간을 잰다.
+// overhead 는 왕복 시간에서 서버가 보고한 계획 시간을 뺀 값 (소켓, 직렬화, 스케줄링 비용)
+//
+// usage: planner_client <socket_path> <order.json | order.bin>
+//                       [--method layered|optimized|stack_all|buffer|stack_with_buffer]
+//                       [--pallet W L H] [--gap N] [--repeat N] [--out result.json|.ndjson|.bin]
+
+namespace {
+
+struct ClientOptions {
+    std::string socket_path;
+    std::filesystem::path order;
+    StackingMethod method = StackingMethod::LAYERED;
+    std::vector<int> pallet_size = {1100, 1100, 1800};
+    int gap = 5;
+    int repeat = 1;
+    std::filesystem::path output;
+};
+
+bool parse_args(int argc, char** argv, ClientOptions& options)
+{
+    if (argc < 3)
+        return false;
+    options.socket_path = argv[1];
+    options.order = argv[2];
+
+    try {
+        for (int i = 3; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--method" && i + 1 < argc)
+            {
+                if (!parse_stacking_method(argv[++i], options.method))
+                    return false;
+            }
+            else if (arg == "--pallet" && i + 3 < argc)
+            {
+                options.pallet_size = {std::stoi(argv[i + 1]), std::stoi(argv[i + 2]), std::stoi(argv[i + 3])};
+                i += 3;
+            }
+            else if (arg == "--gap" && i + 1 < argc)
+            {
+                options.gap = std::stoi(argv[++i]);
+            }
+            else if (arg == "--repeat" && i + 1 < argc)
+            {
+                options.repeat = std::max(1, std::stoi(argv[++i]));
+            }
+            else if (arg == "--out" && i + 1 < argc)
+            {
+                options.output = argv[++i];
+            }
+            else
+            {
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid argument: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 파일을 열 수 없거나 손상되었으면 false
+bool load_order(const std::filesystem::path& order, std::vector<BoxRecord>& records)
+{
+    if (order.extension() == ".bin")
+    {
+        BoxSetFile box_set(order.string());
+        records = box_set.to_records();
+        return box_set.is_open();
+    }
+    return JsonUtils::load_box_records(order.string(), records);
+}
+
+ResultFormat output_format(const std::filesystem::path& output)
+{
+    if (output.extension() == ".ndjson")
+        return ResultFormat::NDJSON;
+    if (output.extension() == ".bin")
+        return ResultFormat::BINARY;
+    return ResultFormat::JSON;
+}
+
+int connect_daemon(const std::string& socket_path)
+{
+    sockaddr_un address;
+    if (!PlannerProtocol::make_address(socket_path, address))
+        return -1;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        std::cerr << "Can't connect to " << socket_path << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0)
+            ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+double percentile(std::vector<double> values, double fraction)
+{
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    ClientOptions options;
+    if (!parse_args(argc, argv, options))
+    {
+        std::cerr << "usage: " << argv[0] << " <socket_path> <order.json | order.bin>\n"
+                  << "       [--method layered|optimized|stack_all|buffer|stack_with_buffer]\n"
+                  << "       [--pallet W L H] [--gap N] [--repeat N] [--out result.json|.ndjson|.bin]" << std::endl;
+        return 1;
+    }
+
+    PlannerProtocol::PlanRequest request;
+    request.method = static_cast<uint32_t>(options.method);
+    request.pallet_size = options.pallet_size;
+    request.gap = options.gap;
+    if (!load_order(options.order, request.boxes))
+    {
+        std::cerr << "Can't read order: " << options.order << std::endl;
+        return 1;
+    }
+    if (request.boxes.empty())
+    {
+        std::cerr << "Empty order: " << options.order << std::endl;
+        return 1;
+    }
+
+    int fd = connect_daemon(options.socket_path);
+    if (fd < 0)
+        return 1;
+
+    std::vector<char> frame;
+    std::vector<char> payload;
+    PlannerProtocol::encode_request(frame, request);
+    PlannerProtocol::PlanResponse response;
+    std::vector<double> rtt_us;
+    std::vector<double> overhead_us;
+    rtt_us.reserve(options.repeat);
+    overhead_us.reserve(options.repeat);
+
+    for (int i = 0; i < options.repeat; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        PlannerProtocol::FrameType type;
+        if (!PlannerProtocol::write_full(fd, frame.data(), frame.size()) ||
+            !PlannerProtocol::recv_frame(fd, type, payload) ||
+            type != PlannerProtocol::FrameType::PLAN_RESPONSE ||
+            !PlannerProtocol::decode_response(payload, response))
+        {
+            std::cerr << "Connection to planner daemon lost" << std::endl;
+            ::close(fd);
+            return 1;
+        }
+        double rtt = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        if (response.status != PlannerProtocol::Status::OK)
+        {
+            std::cerr << "Planner daemon returned status " << static_cast<uint32_t>(response.status) << std::endl;
+            ::close(fd);
+            return 1;
+        }
+        rtt_us.push_back(rtt);
+        overhead_us.push_back(std::max(0.0, rtt - response.plan_ns / 1000.0));
+    }
+    ::close(fd);
+
+    std::cout << "\nPlanner Client Results:" << std::endl;
+    std::cout << "--------------------" << std::endl;
+    size_t moved = std::count_if(response.results.begin(), response.results.end(),
+                                 [](const StackResult& result) { return result.from_pallet != 0; });
+    std::cout << "Boxes: " << request.boxes.size() << ", placements: " << response.results.size()
+              << " (moved from buffer: " << moved << ")" << std::endl;
+    std::cout << "Requests: " << options.repeat << std::endl;
+    std::cout << "Last plan time: " << response.plan_ns / 1000.0 << " us" << std::endl;
+    std::cout << "RTT (us): mean " << std::accumulate(rtt_us.begin(), rtt_us.end(), 0.0) / rtt_us.size()
+              << ", p50 " << percentile(rtt_us, 0.5) << ", p99 " << percentile(rtt_us, 0.99) << std::endl;
+    std::cout << "Overhead (us): mean " << std::accumulate(overhead_us.begin(), overhead_us.end(), 0.0) / overhead_us.size()
+              << ", p50 " << percentile(overhead_us, 0.5) << ", p99 " << percentile(overhead_us, 0.99) << std::endl;
+    std::cout << "--------------------" << std::endl;
+
+    if (!options.output.empty())
+    {
+        ResultWriter writer(options.output.string(), output_format(options.output));
+        writer.write_all(response.results);
+        if (!writer.close())
+            return 1;
+        std::cout << "Results saved to: " << options.output << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,405 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "stackingCore.hpp"
+#include "plannerProtocol.hpp"
+#include "threadPool.hpp"
+
+// 상주 계획 서버. Unix domain socket 으로 주문을 받아 배치를 돌려준다.
+// 프로세스 시작, 라이브러리 로딩, JSON 파싱 비용을 요청마다 치르지 않도록
+// thread pool, worker 별 StackingAlgorithm(과 그 arena), 계획 캐시를 요청 사이에 유지한다.
+//
+// usage: planner_daemon <socket_path> [--threads N] [--cache plan_cache.bin]
+//
+// accept 루프가 요청을 기다리는 연결을 모두 poll 하고, 요청이 도착한 연결만 worker 에 넘긴다.
+// worker 는 요청 하나를 처리해 응답한 뒤 연결을 돌려주므로, 열어 두기만 한 연결은 worker 를 차지하지 않는다.
+// 한 연결의 요청은 여전히 순서대로 처리된다.
+// 프레임을 보내다 멈춘 클라이언트가 worker 를 붙잡지 않도록 송수신에 제한 시간을 둔다.
+// SIGINT/SIGTERM 을 받으면 열린 연결을 끊고 캐시를 기록한 뒤 소켓 파일을 지운다
+
+namespace {
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void handle_stop_signal(int)
+{
+    stop_requested = 1;
+}
+
+struct DaemonOptions {
+    std::string socket_path;
+    size_t threads = std::thread::hardware_concurrency();
+    std::string cache_path;
+};
+
+bool parse_args(int argc, char** argv, DaemonOptions& options)
+{
+    if (argc < 2)
+        return false;
+    options.socket_path = argv[1];
+
+    try {
+        for (int i = 2; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--threads" && i + 1 < argc)
+            {
+                options.threads = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--cache" && i + 1 < argc)
+            {
+                options.cache_path = argv[++i];
+            }
+            else
+            {
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid argument: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 프레임 하나를 주고받는 데 허용하는 시간
+constexpr int IO_TIMEOUT_SECONDS = 10;
+
+// 열린 연결 목록.
+// worker 가 요청을 처리한 연결을 돌려주면 wake pipe 로 accept 루프의 poll 을 깨운다.
+// 종료할 때는 read 에서 기다리는 worker 를 깨우기 위해 모든 연결을 shutdown 한다
+class ConnectionSet {
+public:
+    ConnectionSet()
+    {
+        if (::pipe2(wake_fds, O_CLOEXEC | O_NONBLOCK) != 0)
+        {
+            std::cerr << "pipe: " << std::strerror(errno) << std::endl;
+            wake_fds[0] = wake_fds[1] = -1;
+        }
+    }
+
+    ~ConnectionSet()
+    {
+        for (int fd : fds)
+        {
+            ::close(fd);
+        }
+        for (int fd : wake_fds)
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+    }
+
+    ConnectionSet(const ConnectionSet&) = delete;
+    ConnectionSet& operator=(const ConnectionSet&) = delete;
+
+    bool is_open() const { return wake_fds[0] >= 0; }
+    int wake_fd() const { return wake_fds[0]; }
+
+    void add(int fd)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fds.insert(fd);
+    }
+
+    // worker 가 요청 하나를 끝낸 뒤 부른다. keep 이면 다시 요청을 기다리고, 아니면 닫는다
+    void release(int fd, bool keep)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (keep)
+            {
+                returned.push_back(fd);
+            }
+            else
+            {
+                fds.erase(fd);
+                ::close(fd);
+            }
+        }
+        if (keep)
+        {
+            char byte = 0;
+            [[maybe_unused]] ssize_t n = ::write(wake_fds[1], &byte, 1);
+        }
+    }
+
+    // 돌려받은 연결을 idle 에 옮긴다
+    void take_returned(std::vector<int>& idle)
+    {
+        char drain[64];
+        while (::read(wake_fds[0], drain, sizeof(drain)) > 0)
+        {}
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.insert(idle.end(), returned.begin(), returned.end());
+        returned.clear();
+    }
+
+    void shutdown_all()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int fd : fds)
+        {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::set<int> fds;
+    std::vector<int> returned;
+    int wake_fds[2];
+};
+
+bool valid_request(const PlannerProtocol::PlanRequest& request)
+{
+    if (request.method > static_cast<uint32_t>(StackingMethod::LAYERED))
+        return false;
+    if (request.boxes.empty())
+        return false;
+    // 간격이 0 이면 탐색 루프가 전진하지 않아 worker 가 멈춘다
+    if (!StackingAlgorithm::valid_setup(request.pallet_size, request.gap))
+        return false;
+    for (const auto& box : request.boxes)
+    {
+        for (int dim : box.box_size)
+        {
+            if (dim <= 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+// worker 마다 하나씩 두고 요청마다 reset_order 로 비워 재사용한다
+StackingAlgorithm& worker_planner(const PlannerProtocol::PlanRequest& request, PlanCache* plan_cache)
+{
+    thread_local std::unique_ptr<StackingAlgorithm> planner;
+    if (!planner)
+    {
+        planner = std::make_unique<StackingAlgorithm>(request.pallet_size, request.gap);
+    }
+    else
+    {
+        planner->reset_order(request.pallet_size, request.gap);
+    }
+    planner->set_plan_cache(plan_cache);
+    return *planner;
+}
+
+// 도착한 요청 하나를 읽어 응답한다. 연결을 계속 쓸 수 있으면 true
+bool serve_request(int fd, PlanCache* plan_cache)
+{
+    // 요청/응답 버퍼는 worker 마다 재사용한다
+    thread_local std::vector<char> payload;
+    thread_local std::vector<char> frame;
+    thread_local PlannerProtocol::PlanRequest request;
+    PlannerProtocol::FrameType type;
+
+    if (stop_requested || !PlannerProtocol::recv_frame(fd, type, payload))
+        return false;
+
+    if (type != PlannerProtocol::FrameType::PLAN_REQUEST || !PlannerProtocol::decode_request(payload, request) ||
+        !valid_request(request))
+    {
+        PlannerProtocol::encode_response(frame, PlannerProtocol::Status::BAD_REQUEST, 0, {});
+        return PlannerProtocol::write_full(fd, frame.data(), frame.size());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    PlannerProtocol::Status status = PlannerProtocol::Status::OK;
+    std::vector<StackResult> results;
+    try {
+        StackingAlgorithm& planner = worker_planner(request, plan_cache);
+        planner.reserve_boxes(request.boxes.size());
+        for (const auto& box : request.boxes)
+        {
+            planner.add_box(box);
+        }
+        results = planner.Stack(static_cast<StackingMethod>(request.method));
+    } catch (const std::exception& e) {
+        std::cerr << "Planning failed: " << e.what() << std::endl;
+        status = PlannerProtocol::Status::PLAN_FAILED;
+        results.clear();
+    }
+    auto plan_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    PlannerProtocol::encode_response(frame, status, static_cast<uint64_t>(plan_ns), results);
+    return PlannerProtocol::write_full(fd, frame.data(), frame.size());
+}
+
+int open_listener(const std::string& socket_path)
+{
+    sockaddr_un address;
+    if (!PlannerProtocol::make_address(socket_path, address))
+        return -1;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        std::cerr << "socket: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+
+    // 남아 있는 소켓 파일이 살아 있는 서버의 것인지 확인한 뒤에만 지운다
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+    {
+        std::cerr << "Planner daemon already running on " << socket_path << std::endl;
+        ::close(fd);
+        return -1;
+    }
+    ::close(fd);
+    ::unlink(socket_path.c_str());
+
+    fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 ||
+        ::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(fd, SOMAXCONN) != 0)
+    {
+        std::cerr << "Can't listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0)
+            ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    DaemonOptions options;
+    if (!parse_args(argc, argv, options))
+    {
+        std::cerr << "usage: " << argv[0] << " <socket_path> [--threads N] [--cache plan_cache.bin]" << std::endl;
+        return 1;
+    }
+
+    int listen_fd = open_listener(options.socket_path);
+    if (listen_fd < 0)
+        return 1;
+
+    std::unique_ptr<PlanCache> plan_cache;
+    if (!options.cache_path.empty())
+    {
+        plan_cache = std::make_unique<PlanCache>(options.cache_path, StackingAlgorithm::PLANNER_REVISION);
+        std::cout << "Plan cache: " << options.cache_path << " (" << plan_cache->size() << " plans)" << std::endl;
+    }
+
+    // worker 는 종료 시그널을 막은 채로 만들어 시그널이 항상 accept 루프에 전달되게 한다
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+    ConnectionSet connections;
+    if (!connections.is_open())
+    {
+        ::close(listen_fd);
+        return 1;
+    }
+    {
+        ThreadPool pool(options.threads);
+
+        struct sigaction action{};
+        action.sa_handler = handle_stop_signal;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+        pthread_sigmask(SIG_UNBLOCK, &stop_signals, nullptr);
+
+        std::cout << "Planner daemon listening on " << options.socket_path
+                  << " with " << pool.size() << " threads" << std::endl;
+
+        // 요청을 기다리는 연결. 요청이 도착하면 빼서 worker 에 넘기고, 응답한 뒤 돌려받는다
+        std::vector<int> idle;
+        std::vector<pollfd> watched;
+        while (!stop_requested)
+        {
+            connections.take_returned(idle);
+            watched.clear();
+            watched.push_back({listen_fd, POLLIN, 0});
+            watched.push_back({connections.wake_fd(), POLLIN, 0});
+            for (int fd : idle)
+            {
+                watched.push_back({fd, POLLIN, 0});
+            }
+
+            // 시그널이 poll 진입 직전에 와도 제한 시간 안에 종료 플래그를 확인한다
+            int ready = ::poll(watched.data(), watched.size(), 250);
+            if (ready <= 0)
+                continue;
+
+            // 끊긴 연결 (POLLHUP) 도 worker 에서 읽기가 실패하며 닫힌다
+            for (size_t i = 2; i < watched.size(); i++)
+            {
+                if (watched[i].revents == 0)
+                    continue;
+                int fd = watched[i].fd;
+                idle.erase(std::find(idle.begin(), idle.end(), fd));
+                pool.submit([fd, &connections, cache = plan_cache.get()] {
+                    bool keep = false;
+                    try {
+                        keep = serve_request(fd, cache);
+                    } catch (const std::exception& e) {
+                        std::cerr << "Request failed: " << e.what() << std::endl;
+                    }
+                    connections.release(fd, keep);
+                });
+            }
+
+            if (!(watched[0].revents & POLLIN))
+                continue;
+            int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0)
+            {
+                if (errno != EINTR && errno != EAGAIN)
+                {
+                    std::cerr << "accept: " << std::strerror(errno) << std::endl;
+                }
+                continue;
+            }
+
+            timeval timeout{IO_TIMEOUT_SECONDS, 0};
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            connections.add(fd);
+            idle.push_back(fd);
+        }
+
+        std::cout << "Shutting down planner daemon..." << std::endl;
+        ::close(listen_fd);
+        connections.shutdown_all();
+        pool.wait_idle();
+    }
+
+    if (plan_cache)
+    {
+        plan_cache->flush();
+    }
+    ::unlink(options.socket_path.c_str());
+    return 0;
+}
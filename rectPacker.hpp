@@ -0,0 +1,305 @@
+#ifndef _RECT_PACKER
+#define _RECT_PACKER
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+// 2D 배치 결과. rotated 이면 width/length 가 뒤바뀐 상태로 놓인 것
+struct PackedRect {
+    int x;
+    int y;
+    int width;
+    int length;
+    bool rotated;
+};
+
+// Skyline bottom-left 2D packer.
+// 윗면 윤곽(skyline)을 x 구간별 높이로만 유지하므로 삽입 비용은 구간 수에 비례한다
+class SkylinePacker {
+public:
+    SkylinePacker(int bin_width, int bin_length)
+        : bin_width(bin_width), bin_length(bin_length)
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        skyline.clear();
+        skyline.push_back({0, 0, bin_width});
+    }
+
+    bool insert(int width, int length, bool allow_rotation, PackedRect& out)
+    {
+        int best_y = std::numeric_limits<int>::max();
+        int best_x = std::numeric_limits<int>::max();
+        int best_index = -1;
+        bool best_rotated = false;
+
+        for (int r = 0; r < (allow_rotation && width != length ? 2 : 1); r++)
+        {
+            int w = r ? length : width;
+            int l = r ? width : length;
+            for (size_t i = 0; i < skyline.size(); i++)
+            {
+                int y;
+                if (!fits(i, w, l, y))
+                    continue;
+                if (y < best_y || (y == best_y && skyline[i].x < best_x))
+                {
+                    best_y = y;
+                    best_x = skyline[i].x;
+                    best_index = static_cast<int>(i);
+                    best_rotated = r == 1;
+                }
+            }
+        }
+
+        if (best_index < 0)
+            return false;
+
+        int w = best_rotated ? length : width;
+        int l = best_rotated ? width : length;
+        add_level(best_index, best_x, best_y + l, w);
+        out = {best_x, best_y, w, l, best_rotated};
+        return true;
+    }
+
+private:
+    struct Segment {
+        int x;
+        int y;
+        int width;
+    };
+
+    int bin_width;
+    int bin_length;
+    std::vector<Segment> skyline;
+
+    // segment index 에서 시작해 폭 w 를 덮는 구간들의 최대 높이를 y 로 돌려준다
+    bool fits(size_t index, int w, int l, int& y) const
+    {
+        int x = skyline[index].x;
+        if (x + w > bin_width)
+            return false;
+
+        int remaining = w;
+        y = skyline[index].y;
+        for (size_t i = index; remaining > 0; i++)
+        {
+            y = std::max(y, skyline[i].y);
+            if (y + l > bin_length)
+                return false;
+            remaining -= skyline[i].width;
+        }
+        return true;
+    }
+
+    void add_level(size_t index, int x, int y, int w)
+    {
+        skyline.insert(skyline.begin() + index, {x, y, w});
+
+        // 새 구간에 가려진 뒤쪽 구간을 잘라낸다
+        for (size_t i = index + 1; i < skyline.size(); )
+        {
+            int covered_end = skyline[i - 1].x + skyline[i - 1].width;
+            if (skyline[i].x >= covered_end)
+                break;
+
+            int shrink = covered_end - skyline[i].x;
+            skyline[i].x += shrink;
+            skyline[i].width -= shrink;
+            if (skyline[i].width <= 0)
+            {
+                skyline.erase(skyline.begin() + i);
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        // 같은 높이의 이웃 구간 병합
+        for (size_t i = 0; i + 1 < skyline.size(); )
+        {
+            if (skyline[i].y == skyline[i + 1].y)
+            {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + i + 1);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+};
+
+// MaxRects 2D packer (bottom-left on a grid).
+// 비어 있는 최대 직사각형 목록을 유지하고, grid 배수 좌표 중 가장 낮은 y (같으면 가장 작은 x) 자리에 놓는다.
+// 놓일 수 있는 격자점은 그 점을 품은 최대 빈 사각형의 왼쪽 아래를 격자로 올림한 점보다 앞서지 않으므로,
+// 격자를 y, x 순서로 훑어 처음 비어 있는 자리를 고르는 것과 같은 결과를 빈 사각형 수만큼만 보고 얻는다.
+// remove 로 놓인 사각형을 다시 빈 공간으로 돌려줄 수 있다
+class MaxRectsPacker {
+public:
+    MaxRectsPacker(int bin_width, int bin_length, int grid = 1)
+        : bin_width(bin_width), bin_length(bin_length), grid(std::max(grid, 1))
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        free_rects.clear();
+        free_rects.push_back({0, 0, bin_width, bin_length});
+        used_rects.clear();
+    }
+
+    bool insert(int width, int length, bool allow_rotation, PackedRect& out)
+    {
+        int best_y = std::numeric_limits<int>::max();
+        int best_x = std::numeric_limits<int>::max();
+        bool found = false;
+
+        for (const auto& free_rect : free_rects)
+        {
+            for (int r = 0; r < (allow_rotation && width != length ? 2 : 1); r++)
+            {
+                int w = r ? length : width;
+                int l = r ? width : length;
+                int x = align(free_rect.x);
+                int y = align(free_rect.y);
+                if (x + w > free_rect.x + free_rect.width || y + l > free_rect.y + free_rect.length)
+                    continue;
+
+                if (y < best_y || (y == best_y && x < best_x))
+                {
+                    best_y = y;
+                    best_x = x;
+                    out = {x, y, w, l, r == 1};
+                    found = true;
+                }
+            }
+        }
+
+        if (found)
+        {
+            place(out);
+            used_rects.push_back(out);
+        }
+        return found;
+    }
+
+    // 놓여 있던 사각형을 빈 공간으로 되돌린다.
+    // 풀린 자리는 여러 빈 사각형과 부분적으로 겹칠 수 있어 이웃 병합만으로는 최대 사각형을 다 찾지 못하므로,
+    // 남은 사각형으로 빈 목록을 다시 만든다. 비용은 놓인 사각형 수 x 빈 사각형 수 정도다
+    bool remove(const PackedRect& rect)
+    {
+        auto it = std::find_if(used_rects.begin(), used_rects.end(), [&](const PackedRect& used) {
+            return used.x == rect.x && used.y == rect.y && used.width == rect.width && used.length == rect.length;
+        });
+        if (it == used_rects.end())
+            return false;
+        used_rects.erase(it);
+
+        free_rects.clear();
+        free_rects.push_back({0, 0, bin_width, bin_length});
+        for (const auto& used : used_rects)
+        {
+            place(used);
+        }
+        return true;
+    }
+
+    size_t free_count() const
+    {
+        return free_rects.size();
+    }
+
+private:
+    struct Rect {
+        int x;
+        int y;
+        int width;
+        int length;
+    };
+
+    int bin_width;
+    int bin_length;
+    int grid;
+    std::vector<Rect> free_rects;
+    std::vector<PackedRect> used_rects;     // 놓인 순서
+
+    int align(int value) const
+    {
+        return (value + grid - 1) / grid * grid;
+    }
+
+    static bool intersects(const Rect& a, const PackedRect& b)
+    {
+        return a.x < b.x + b.width && b.x < a.x + a.width &&
+               a.y < b.y + b.length && b.y < a.y + a.length;
+    }
+
+    static bool contains(const Rect& outer, const Rect& inner)
+    {
+        return inner.x >= outer.x && inner.y >= outer.y &&
+               inner.x + inner.width <= outer.x + outer.width &&
+               inner.y + inner.length <= outer.y + outer.length;
+    }
+
+    void place(const PackedRect& used)
+    {
+        std::vector<Rect> split;
+        for (size_t i = 0; i < free_rects.size(); )
+        {
+            Rect f = free_rects[i];
+            if (!intersects(f, used))
+            {
+                i++;
+                continue;
+            }
+
+            // 사용된 영역을 제외한 좌/우/하/상 최대 사각형
+            if (used.x > f.x)
+                split.push_back({f.x, f.y, used.x - f.x, f.length});
+            if (used.x + used.width < f.x + f.width)
+                split.push_back({used.x + used.width, f.y, f.x + f.width - used.x - used.width, f.length});
+            if (used.y > f.y)
+                split.push_back({f.x, f.y, f.width, used.y - f.y});
+            if (used.y + used.length < f.y + f.length)
+                split.push_back({f.x, used.y + used.length, f.width, f.y + f.length - used.y - used.length});
+
+            free_rects[i] = free_rects.back();
+            free_rects.pop_back();
+        }
+        free_rects.insert(free_rects.end(), split.begin(), split.end());
+        prune();
+    }
+
+    void prune()
+    {
+        for (size_t i = 0; i < free_rects.size(); i++)
+        {
+            for (size_t j = i + 1; j < free_rects.size(); )
+            {
+                if (contains(free_rects[i], free_rects[j]))
+                {
+                    free_rects.erase(free_rects.begin() + j);
+                }
+                else if (contains(free_rects[j], free_rects[i]))
+                {
+                    free_rects.erase(free_rects.begin() + i);
+                    j = i + 1;
+                }
+                else
+                {
+                    j++;
+                }
+            }
+        }
+    }
+};
+
+#endif
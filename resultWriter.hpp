@@ -0,0 +1,281 @@
+#ifndef _RESULT_WRITER
+#define _RESULT_WRITER
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <charconv>
+
+#include "stackResult.hpp"
+
+enum class ResultFormat {
+    NDJSON,     // 한 줄에 배치 하나. 쓰는 즉시 읽을 수 있다
+    JSON,       // 공백 없는 JSON 배열. 기존 결과 파일의 필드 + from_pallet
+    BINARY      // 고정 크기 레코드 (아래 레이아웃 참고)
+};
+
+// Streaming placement writer.
+// DOM 없이 StackResult 를 바로 문자열/바이트로 바꿔 버퍼에 쌓고, 버퍼가 차면 파일로 내보낸다.
+// sink() 를 StackingAlgorithm::set_result_sink 에 넘기면 배치가 결정되는 대로 기록된다.
+// BINARY layout: "STKRES\0\0" magic, u32 version, u32 record_size, u64 count,
+//                then records of i32 box_id, x, y, z, rot, pallet_id, from_pallet.
+// from_pallet 이 0 이 아니면 그 팔레트에서 옮겨 온 배치로, 앞선 같은 box_id 기록을 대체한다.
+// count 는 close 시점에 채워지며, 0 이면 파일 끝까지 읽으면 된다
+class ResultWriter {
+public:
+    ResultWriter(const std::string& filename, ResultFormat format)
+        : filename(filename), format(format)
+    {
+        file.open(filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "Can't open: " << filename << std::endl;
+            return;
+        }
+        buffer.reserve(FLUSH_BYTES + 256);
+
+        if (format == ResultFormat::JSON)
+        {
+            buffer.push_back('[');
+        }
+        else if (format == ResultFormat::BINARY)
+        {
+            BinaryHeader header{};
+            std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+            header.version = VERSION;
+            header.record_size = sizeof(BinaryRecord);
+            append(&header, sizeof(header));
+        }
+    }
+
+    ~ResultWriter()
+    {
+        close();
+    }
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    bool is_open() const { return file.is_open(); }
+    size_t count() const { return written; }
+
+    void write(const StackResult& result)
+    {
+        if (!file.is_open())
+            return;
+
+        if (format == ResultFormat::BINARY)
+        {
+            BinaryRecord record{
+                numeric_id(result.box_id),
+                std::get<0>(result.box_loc),
+                std::get<1>(result.box_loc),
+                std::get<2>(result.box_loc),
+                result.box_rot,
+                result.pallet_id,
+                result.from_pallet
+            };
+            append(&record, sizeof(record));
+        }
+        else
+        {
+            if (format == ResultFormat::JSON && written > 0)
+            {
+                buffer.push_back(',');
+            }
+            append_json(result);
+            if (format == ResultFormat::NDJSON)
+            {
+                buffer.push_back('\n');
+            }
+        }
+        written++;
+
+        if (buffer.size() >= FLUSH_BYTES)
+        {
+            flush();
+        }
+    }
+
+    void write_all(const std::vector<StackResult>& results)
+    {
+        for (const auto& result : results)
+        {
+            write(result);
+        }
+    }
+
+    StackResultSink sink()
+    {
+        return [this](const StackResult& result) { write(result); };
+    }
+
+    // NDJSON 은 한 줄씩 바로 소비할 수 있도록 버퍼를 비울 때 파일도 flush 한다
+    void flush()
+    {
+        if (!file.is_open())
+            return;
+        file.write(buffer.data(), buffer.size());
+        buffer.clear();
+        if (format == ResultFormat::NDJSON)
+        {
+            file.flush();
+        }
+    }
+
+    bool close()
+    {
+        if (!file.is_open())
+            return false;
+
+        if (format == ResultFormat::JSON)
+        {
+            buffer.append("]\n");
+        }
+        flush();
+
+        if (format == ResultFormat::BINARY)
+        {
+            uint64_t count = written;
+            file.seekp(offsetof(BinaryHeader, count));
+            file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        }
+
+        bool ok = static_cast<bool>(file);
+        file.close();
+        if (!ok)
+        {
+            std::cerr << "Failed to write: " << filename << std::endl;
+        }
+        return ok;
+    }
+
+private:
+    static constexpr size_t FLUSH_BYTES = 1 << 16;
+    static constexpr const char* MAGIC = "STKRES\0\0";
+    // 2: from_pallet 추가
+    static constexpr uint32_t VERSION = 2;
+
+    struct BinaryHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_size;
+        uint64_t count;
+    };
+
+    struct BinaryRecord {
+        int32_t box_id;
+        int32_t x;
+        int32_t y;
+        int32_t z;
+        int32_t rot;
+        int32_t pallet_id;
+        int32_t from_pallet;
+    };
+
+    std::string filename;
+    ResultFormat format;
+    std::ofstream file;
+    std::string buffer;
+    size_t written = 0;
+
+    void append(const void* data, size_t bytes)
+    {
+        buffer.append(static_cast<const char*>(data), bytes);
+    }
+
+    void append_int(long long value)
+    {
+        char digits[24];
+        auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, end);
+    }
+
+    // int32 범위의 10진 정수이고 앞자리 0 이 없어 JSON 숫자로 그대로 쓸 수 있는지
+    static bool is_integer(const std::string& text)
+    {
+        size_t start = !text.empty() && text[0] == '-' ? 1 : 0;
+        if (start == text.size() || (text[start] == '0' && text.size() > start + 1))
+            return false;
+        int32_t value;
+        const char* last = text.data() + text.size();
+        auto parsed = std::from_chars(text.data(), last, value);
+        return parsed.ec == std::errc() && parsed.ptr == last;
+    }
+
+    // JSON 문자열 본문. 따옴표, 역슬래시와 0x20 미만의 제어 문자를 escape 한다
+    void append_escaped(const std::string& text)
+    {
+        static constexpr char HEX[] = "0123456789abcdef";
+        for (char c : text)
+        {
+            unsigned char code = static_cast<unsigned char>(c);
+            switch (c)
+            {
+                case '"': buffer.append("\\\""); break;
+                case '\\': buffer.append("\\\\"); break;
+                case '\b': buffer.append("\\b"); break;
+                case '\f': buffer.append("\\f"); break;
+                case '\n': buffer.append("\\n"); break;
+                case '\r': buffer.append("\\r"); break;
+                case '\t': buffer.append("\\t"); break;
+                default:
+                    if (code < 0x20)
+                    {
+                        buffer.append("\\u00");
+                        buffer.push_back(HEX[code >> 4]);
+                        buffer.push_back(HEX[code & 0xF]);
+                    }
+                    else
+                    {
+                        buffer.push_back(c);
+                    }
+            }
+        }
+    }
+
+    static int32_t numeric_id(const std::string& box_id)
+    {
+        if (!is_integer(box_id))
+        {
+            std::cerr << "Non-numeric box ID in binary result: " << box_id << std::endl;
+            return -1;
+        }
+        return static_cast<int32_t>(std::stoll(box_id));
+    }
+
+    // 기존 결과 파일의 필드에 from_pallet 을 더한다. 숫자 id 는 숫자로, 그 외에는 문자열로 쓴다
+    void append_json(const StackResult& result)
+    {
+        buffer.append("{\"box_id\":");
+        if (is_integer(result.box_id))
+        {
+            buffer.append(result.box_id);
+        }
+        else
+        {
+            buffer.push_back('"');
+            append_escaped(result.box_id);
+            buffer.push_back('"');
+        }
+        buffer.append(",\"box_loc\":[");
+        append_int(std::get<0>(result.box_loc));
+        buffer.push_back(',');
+        append_int(std::get<1>(result.box_loc));
+        buffer.push_back(',');
+        append_int(std::get<2>(result.box_loc));
+        buffer.append("],\"box_rot\":");
+        append_int(result.box_rot);
+        buffer.append(",\"pallet_id\":");
+        append_int(result.pallet_id);
+        buffer.append(",\"from_pallet\":");
+        append_int(result.from_pallet);
+        buffer.push_back('}');
+    }
+};
+
+#endif
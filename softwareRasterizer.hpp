@@ -0,0 +1,341 @@
+#ifndef _SOFTWARE_RASTERIZER
+#define _SOFTWARE_RASTERIZER
+
+#include <vector>
+#include <array>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include <opencv2/opencv.hpp>
+
+#include "geometryTypes.hpp"
+
+// 버퍼의 채널 순서. cv::Mat 프레임은 BGR
+enum class PixelOrder {
+    BGR,
+    RGB
+};
+
+// In-process box renderer.
+// gnuplot 의 "set view rot_x, rot_z" 와 같은 투영으로 팔레트 하나를 viewport 안에 그린다.
+// 면은 깊이순(painter's order)으로 정렬해 뒤에서부터 반투명으로 채우고 테두리를 그리므로
+// 가려진 박스도 gnuplot 의 transparent solid 처럼 비쳐 보인다.
+// 면 목록 등 작업 버퍼를 재사용하므로 스레드마다 인스턴스를 하나씩 둔다
+class SoftwareRasterizer {
+public:
+    // boxes 는 OBB 를 차례로 내놓는 범위 (std::vector<OBB>, FrameStateLog::Cursor::PalletView 등)
+    template <typename Boxes>
+    void draw_view(cv::Mat& frame,
+                   const cv::Rect& viewport,
+                   const Boxes& boxes,
+                   const std::vector<double>& cubic_range,
+                   double rot_x,
+                   double rot_z,
+                   const cv::Scalar& fill_color,
+                   const std::string& title,
+                   double opacity = 0.5)
+    {
+        cv::Rect area = viewport & cv::Rect(0, 0, frame.cols, frame.rows);
+        if (area.empty())
+            return;
+
+        fill_rect(frame, area, WHITE);
+        setup_projection(area, cubic_range, rot_x, rot_z);
+        draw_grid(frame, area);
+
+        face_count = 0;
+        for (const auto& box : boxes)
+        {
+            add_box_faces(box);
+        }
+        order.resize(face_count);
+        for (size_t i = 0; i < face_count; i++)
+        {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(),
+            [this](size_t a, size_t b) { return faces[a].depth < faces[b].depth; });
+
+        int alpha = static_cast<int>(std::lround(std::clamp(opacity, 0.0, 1.0) * 256));
+        for (size_t index : order)
+        {
+            const Face& face = faces[index];
+            fill_polygon(frame, area, face.points, fill_color, alpha);
+            for (size_t i = 0; i < face.points.size(); i++)
+            {
+                draw_line(frame, area, face.points[i], face.points[(i + 1) % face.points.size()], BLACK);
+            }
+        }
+
+        if (!title.empty())
+        {
+            int baseline = 0;
+            double scale = std::max(0.4, area.height / 1600.0);
+            cv::Size text = cv::getTextSize(title, cv::FONT_HERSHEY_SIMPLEX, scale, 1, &baseline);
+            cv::Point origin(area.x + std::max(0, (area.width - text.width) / 2), area.y + text.height + TITLE_MARGIN / 2);
+            cv::putText(frame, title, origin, cv::FONT_HERSHEY_SIMPLEX, scale, BLACK, 1, cv::LINE_AA);
+        }
+    }
+
+    // 원시 버퍼(3채널, 행 간격 stride 바이트)에 그린다. RGB 버퍼면 색만 뒤집어서 같은 경로를 쓴다
+    template <typename Boxes>
+    void draw_view(uint8_t* pixels, int width, int height, size_t stride, PixelOrder order,
+                   const cv::Rect& viewport,
+                   const Boxes& boxes,
+                   const std::vector<double>& cubic_range,
+                   double rot_x,
+                   double rot_z,
+                   const cv::Scalar& fill_color,
+                   const std::string& title,
+                   double opacity = 0.5)
+    {
+        cv::Mat frame(height, width, CV_8UC3, pixels, stride);
+        cv::Scalar color = order == PixelOrder::RGB
+            ? cv::Scalar(fill_color[2], fill_color[1], fill_color[0])
+            : fill_color;
+        draw_view(frame, viewport, boxes, cubic_range, rot_x, rot_z, color, title, opacity);
+    }
+
+    // gnuplot 의 0xRRGGBB 색을 BGR Scalar 로
+    static cv::Scalar rgb_color(uint32_t rgb)
+    {
+        return cv::Scalar(rgb & 0xFF, (rgb >> 8) & 0xFF, (rgb >> 16) & 0xFF);
+    }
+
+private:
+    static constexpr int TITLE_MARGIN = 40;
+    static constexpr int MARGIN = 20;
+    static constexpr int GRID_DIVISIONS = 5;
+    inline static const cv::Scalar WHITE{255, 255, 255};
+    inline static const cv::Scalar BLACK{0, 0, 0};
+    inline static const cv::Scalar GRID{200, 200, 200};
+    inline static const cv::Scalar BORDER{120, 120, 120};
+
+    struct ScreenPoint {
+        double x;
+        double y;
+    };
+
+    struct Face {
+        std::vector<ScreenPoint> points;
+        double depth;
+    };
+
+    // 투영: 축마다 [-1, 1] 로 정규화 -> z 축 회전 -> x 축 회전 -> viewport 에 맞춤
+    double cos_z = 1, sin_z = 0, cos_x = 1, sin_x = 0;
+    std::array<double, 3> range = {1, 1, 1};
+    double scale = 1, offset_x = 0, offset_y = 0;
+
+    // 면 목록은 프레임 사이에 재사용한다 (face_count 까지만 유효)
+    std::vector<Face> faces;
+    std::vector<size_t> order;
+    size_t face_count = 0;
+
+    void setup_projection(const cv::Rect& area, const std::vector<double>& cubic_range, double rot_x, double rot_z)
+    {
+        const double to_radians = M_PI / 180.0;
+        cos_z = std::cos(rot_z * to_radians);
+        sin_z = std::sin(rot_z * to_radians);
+        cos_x = std::cos(rot_x * to_radians);
+        sin_x = std::sin(rot_x * to_radians);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            range[axis] = cubic_range.size() > static_cast<size_t>(axis) && cubic_range[axis] > 0 ? cubic_range[axis] : 1.0;
+        }
+
+        // 팔레트 공간의 8 꼭짓점이 viewport 에 들어가도록 배율을 정한다
+        double min_x = 1e300, max_x = -1e300, min_y = 1e300, max_y = -1e300;
+        scale = 1;
+        offset_x = offset_y = 0;
+        for (int corner = 0; corner < 8; corner++)
+        {
+            double depth;
+            ScreenPoint p = project((corner & 1) * range[0], ((corner >> 1) & 1) * range[1], ((corner >> 2) & 1) * range[2], depth);
+            min_x = std::min(min_x, p.x);
+            max_x = std::max(max_x, p.x);
+            min_y = std::min(min_y, p.y);
+            max_y = std::max(max_y, p.y);
+        }
+        double usable_w = std::max(1, area.width - 2 * MARGIN);
+        double usable_h = std::max(1, area.height - TITLE_MARGIN - MARGIN);
+        scale = std::min(usable_w / std::max(1e-9, max_x - min_x), usable_h / std::max(1e-9, max_y - min_y));
+        offset_x = area.x + MARGIN + (usable_w - (max_x - min_x) * scale) / 2 - min_x * scale;
+        offset_y = area.y + TITLE_MARGIN + (usable_h - (max_y - min_y) * scale) / 2 - min_y * scale;
+    }
+
+    // 화면 y 는 아래로 증가. depth 가 클수록 보는 쪽에 가깝다
+    ScreenPoint project(double x, double y, double z, double& depth) const
+    {
+        double nx = 2.0 * x / range[0] - 1.0;
+        double ny = 2.0 * y / range[1] - 1.0;
+        double nz = 2.0 * z / range[2] - 1.0;
+
+        double rx = nx * cos_z + ny * sin_z;
+        double ry = -nx * sin_z + ny * cos_z;
+        double sy = ry * cos_x + nz * sin_x;
+        depth = -ry * sin_x + nz * cos_x;
+        return {offset_x + rx * scale, offset_y - sy * scale};
+    }
+
+    Face& next_face()
+    {
+        if (face_count == faces.size())
+            faces.emplace_back();
+        return faces[face_count++];
+    }
+
+    void add_face(const std::array<std::array<double, 3>, 4>& vertices)
+    {
+        Face& face = next_face();
+        face.points.resize(4);
+        face.depth = 0;
+        for (size_t i = 0; i < 4; i++)
+        {
+            double depth;
+            face.points[i] = project(vertices[i][0], vertices[i][1], vertices[i][2], depth);
+            face.depth += depth / 4;
+        }
+    }
+
+    void add_box_faces(const OBB& box)
+    {
+        const Quad& c = box.corners;
+        double bottom = box.z;
+        double top = box.z_top();
+        add_face({{{c[0].x, c[0].y, bottom}, {c[1].x, c[1].y, bottom}, {c[2].x, c[2].y, bottom}, {c[3].x, c[3].y, bottom}}});
+        add_face({{{c[0].x, c[0].y, top}, {c[1].x, c[1].y, top}, {c[2].x, c[2].y, top}, {c[3].x, c[3].y, top}}});
+        for (size_t i = 0; i < c.size(); i++)
+        {
+            size_t j = (i + 1) % c.size();
+            add_face({{{c[i].x, c[i].y, bottom}, {c[j].x, c[j].y, bottom}, {c[j].x, c[j].y, top}, {c[i].x, c[i].y, top}}});
+        }
+    }
+
+    void draw_grid(cv::Mat& frame, const cv::Rect& area)
+    {
+        // 바닥 격자
+        for (int i = 0; i <= GRID_DIVISIONS; i++)
+        {
+            double t = static_cast<double>(i) / GRID_DIVISIONS;
+            draw_segment(frame, area, {t * range[0], 0, 0}, {t * range[0], range[1], 0}, GRID);
+            draw_segment(frame, area, {0, t * range[1], 0}, {range[0], t * range[1], 0}, GRID);
+        }
+        // 팔레트 공간 외곽선
+        for (int corner = 0; corner < 8; corner++)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (corner & (1 << axis))
+                    continue;
+                int other = corner | (1 << axis);
+                draw_segment(frame, area,
+                    {(corner & 1) * range[0], ((corner >> 1) & 1) * range[1], ((corner >> 2) & 1) * range[2]},
+                    {(other & 1) * range[0], ((other >> 1) & 1) * range[1], ((other >> 2) & 1) * range[2]},
+                    BORDER);
+            }
+        }
+    }
+
+    void draw_segment(cv::Mat& frame, const cv::Rect& area,
+                      const std::array<double, 3>& from, const std::array<double, 3>& to, const cv::Scalar& color)
+    {
+        double depth;
+        ScreenPoint a = project(from[0], from[1], from[2], depth);
+        ScreenPoint b = project(to[0], to[1], to[2], depth);
+        draw_line(frame, area, a, b, color);
+    }
+
+    static void fill_rect(cv::Mat& frame, const cv::Rect& area, const cv::Scalar& color)
+    {
+        for (int y = area.y; y < area.y + area.height; y++)
+        {
+            uint8_t* row = frame.ptr<uint8_t>(y) + area.x * 3;
+            for (int x = 0; x < area.width; x++)
+            {
+                row[3 * x] = static_cast<uint8_t>(color[0]);
+                row[3 * x + 1] = static_cast<uint8_t>(color[1]);
+                row[3 * x + 2] = static_cast<uint8_t>(color[2]);
+            }
+        }
+    }
+
+    // 볼록 다각형 scanline 채우기. alpha 는 0..256
+    static void fill_polygon(cv::Mat& frame, const cv::Rect& area, const std::vector<ScreenPoint>& points,
+                             const cv::Scalar& color, int alpha)
+    {
+        double min_y = points[0].y, max_y = points[0].y;
+        for (const auto& p : points)
+        {
+            min_y = std::min(min_y, p.y);
+            max_y = std::max(max_y, p.y);
+        }
+        int y_begin = std::max(area.y, static_cast<int>(std::ceil(min_y - 0.5)));
+        int y_end = std::min(area.y + area.height - 1, static_cast<int>(std::floor(max_y - 0.5)));
+
+        const int inverse = 256 - alpha;
+        const int blend[3] = {
+            static_cast<int>(color[0]) * alpha,
+            static_cast<int>(color[1]) * alpha,
+            static_cast<int>(color[2]) * alpha
+        };
+
+        for (int y = y_begin; y <= y_end; y++)
+        {
+            double scan_y = y + 0.5;
+            double left = 1e300, right = -1e300;
+            for (size_t i = 0; i < points.size(); i++)
+            {
+                const ScreenPoint& a = points[i];
+                const ScreenPoint& b = points[(i + 1) % points.size()];
+                if ((a.y <= scan_y && b.y > scan_y) || (b.y <= scan_y && a.y > scan_y))
+                {
+                    double x = a.x + (scan_y - a.y) * (b.x - a.x) / (b.y - a.y);
+                    left = std::min(left, x);
+                    right = std::max(right, x);
+                }
+            }
+            if (left > right)
+                continue;
+
+            int x_begin = std::max(area.x, static_cast<int>(std::ceil(left - 0.5)));
+            int x_end = std::min(area.x + area.width - 1, static_cast<int>(std::floor(right - 0.5)));
+            uint8_t* row = frame.ptr<uint8_t>(y);
+            for (int x = x_begin; x <= x_end; x++)
+            {
+                uint8_t* pixel = row + 3 * x;
+                pixel[0] = static_cast<uint8_t>((pixel[0] * inverse + blend[0]) >> 8);
+                pixel[1] = static_cast<uint8_t>((pixel[1] * inverse + blend[1]) >> 8);
+                pixel[2] = static_cast<uint8_t>((pixel[2] * inverse + blend[2]) >> 8);
+            }
+        }
+    }
+
+    // 1px DDA. viewport 밖의 픽셀은 건너뛴다
+    static void draw_line(cv::Mat& frame, const cv::Rect& area, const ScreenPoint& a, const ScreenPoint& b,
+                          const cv::Scalar& color)
+    {
+        double dx = b.x - a.x;
+        double dy = b.y - a.y;
+        int steps = static_cast<int>(std::ceil(std::max(std::abs(dx), std::abs(dy))));
+        if (steps == 0)
+            steps = 1;
+        if (steps > 4 * (area.width + area.height))
+            return;
+
+        for (int i = 0; i <= steps; i++)
+        {
+            int x = static_cast<int>(std::floor(a.x + dx * i / steps));
+            int y = static_cast<int>(std::floor(a.y + dy * i / steps));
+            if (x < area.x || y < area.y || x >= area.x + area.width || y >= area.y + area.height)
+                continue;
+            uint8_t* pixel = frame.ptr<uint8_t>(y) + 3 * x;
+            pixel[0] = static_cast<uint8_t>(color[0]);
+            pixel[1] = static_cast<uint8_t>(color[1]);
+            pixel[2] = static_cast<uint8_t>(color[2]);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef _STACK_RESULT
+#define _STACK_RESULT
+
+#include <string>
+#include <tuple>
+#include <functional>
+
+// 박스 하나의 배치 결과. box_loc 은 바닥면 중심 (x, y) 와 바닥 높이 z
+struct StackResult {
+    std::string box_id;
+    std::tuple<int, int, int> box_loc;
+    int box_rot;
+    int pallet_id;     // 1 = 메인 팔레트, 2 = 버퍼 팔레트
+    int from_pallet = 0;    // 다른 팔레트에서 옮겨 온 배치면 그 팔레트 (2 = 버퍼에서 메인으로 이동), 새 배치면 0
+};
+
+// 배치가 결정될 때마다 호출된다.
+// 버퍼에서 메인으로 옮겨진 박스는 같은 box_id, from_pallet = 2 로 다시 호출되며, 나중 기록이 앞선 기록을 대체한다
+using StackResultSink = std::function<void(const StackResult&)>;
+
+#endif
@@ -0,0 +1,289 @@
+#ifndef _STACKING_BOUNDS
+#define _STACKING_BOUNDS
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <set>
+
+// 적재 결과 평가용 하한/갭 정보
+struct BoundsReport {
+    int lower_bound_l1 = 0;          // 모든 박스를 싣는 데 필요한 팔레트 수 하한 (Martello-Pisinger-Vigo L1)
+    int lower_bound_l2 = 0;          // 부피를 함께 고려한 하한 (Martello-Pisinger-Vigo L2)
+    double placed_volume = 0;
+    double volume_upper_bound = 0;   // min(팔레트 부피, 전체 박스 부피)
+    double optimality_gap = 0;       // (upper_bound - placed) / upper_bound
+};
+
+// Incremental feasibility bounds for one pallet.
+// 배치된 박스 부피로 남은 부피를 추적하고, 배치에 실패한 박스 치수의 파레토 경계를 유지한다.
+// 점유 공간은 늘어나기만 하므로 실패한 박스보다 모든 축에서 크거나 같은 박스는 탐색 없이 실패로 판단할 수 있다.
+class PalletBounds {
+public:
+    PalletBounds(const std::vector<int>& pallet_size, bool allow_rotation)
+        : pallet{pallet_size[0], pallet_size[1], pallet_size[2]},
+          allow_rotation(allow_rotation),
+          free_volume(static_cast<int64_t>(pallet_size[0]) * pallet_size[1] * pallet_size[2])
+    {}
+
+    // true 이면 이 박스는 현재 팔레트 어디에도 놓일 수 없다
+    bool is_hopeless(const std::vector<int>& dims) const
+    {
+        int64_t volume = static_cast<int64_t>(dims[0]) * dims[1] * dims[2];
+        if (volume > free_volume)
+            return true;
+
+        if (dims[2] > pallet[2])
+            return true;
+        bool fits_as_is = dims[0] <= pallet[0] && dims[1] <= pallet[1];
+        bool fits_rotated = allow_rotation && dims[1] <= pallet[0] && dims[0] <= pallet[1];
+        if (!fits_as_is && !fits_rotated)
+            return true;
+
+        for (const auto& failed : failed_frontier)
+        {
+            if (dims[2] < failed[2])
+                continue;
+            if (dims[0] >= failed[0] && dims[1] >= failed[1])
+                return true;
+            // 회전을 허용하는 탐색에서는 두 방향 모두 실패했으므로 뒤집힌 지배 관계도 성립한다
+            if (allow_rotation && dims[0] >= failed[1] && dims[1] >= failed[0])
+                return true;
+        }
+        return false;
+    }
+
+    void add_placed(const std::vector<int>& dims)
+    {
+        free_volume -= static_cast<int64_t>(dims[0]) * dims[1] * dims[2];
+    }
+
+    void add_failed(const std::vector<int>& dims)
+    {
+        std::array<int, 3> entry{dims[0], dims[1], dims[2]};
+        for (const auto& failed : failed_frontier)
+        {
+            if (entry[0] >= failed[0] && entry[1] >= failed[1] && entry[2] >= failed[2])
+                return;
+        }
+        failed_frontier.erase(std::remove_if(failed_frontier.begin(), failed_frontier.end(),
+            [&](const std::array<int, 3>& failed) {
+                return failed[0] >= entry[0] && failed[1] >= entry[1] && failed[2] >= entry[2];
+            }), failed_frontier.end());
+        failed_frontier.push_back(entry);
+    }
+
+    int64_t remaining_volume() const
+    {
+        return free_volume;
+    }
+
+    static BoundsReport report(const std::vector<std::vector<int>>& box_dims,
+                               const std::vector<int>& pallet_size,
+                               double placed_volume,
+                               bool allow_rotation)
+    {
+        BoundsReport result;
+        double total_volume = 0;
+        for (const auto& dims : box_dims)
+        {
+            total_volume += static_cast<double>(dims[0]) * dims[1] * dims[2];
+        }
+        double pallet_volume = static_cast<double>(pallet_size[0]) * pallet_size[1] * pallet_size[2];
+
+        result.lower_bound_l1 = lower_bound_l1(box_dims, pallet_size, allow_rotation);
+        result.lower_bound_l2 = lower_bound_l2(box_dims, pallet_size, allow_rotation);
+        result.placed_volume = placed_volume;
+        result.volume_upper_bound = std::min(pallet_volume, total_volume);
+        result.optimality_gap = result.volume_upper_bound > 0
+            ? (result.volume_upper_bound - placed_volume) / result.volume_upper_bound
+            : 0.0;
+        return result;
+    }
+
+    // L1 = max over axis pairs of the 1D Martello-Toth bound on the third axis,
+    // restricted to boxes larger than half the pallet on both paired axes
+    static int lower_bound_l1(const std::vector<std::vector<int>>& box_dims,
+                              const std::vector<int>& pallet_size,
+                              bool allow_rotation)
+    {
+        int best = box_dims.empty() ? 0 : 1;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            best = std::max(best, axis_bound_l1(box_dims, pallet_size, allow_rotation, axis));
+        }
+        return best;
+    }
+
+    static int lower_bound_l2(const std::vector<std::vector<int>>& box_dims,
+                              const std::vector<int>& pallet_size,
+                              bool allow_rotation)
+    {
+        int best = lower_bound_l1(box_dims, pallet_size, allow_rotation);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            best = std::max(best, axis_bound_l2(box_dims, pallet_size, allow_rotation, axis));
+        }
+        return best;
+    }
+
+private:
+    std::array<int, 3> pallet;
+    bool allow_rotation;
+    int64_t free_volume;
+    std::vector<std::array<int, 3>> failed_frontier;
+
+    // axis 를 높이 방향으로 보고, 나머지 두 축의 크기를 반환한다.
+    // z 축 회전이 허용되면 x/y 방향 길이는 어느 방향이든 min(x, y) 이상이다
+    static std::array<int, 3> projected(const std::vector<int>& dims, bool allow_rotation, int axis)
+    {
+        int x = dims[0], y = dims[1], z = dims[2];
+        if (allow_rotation)
+        {
+            x = y = std::min(dims[0], dims[1]);
+        }
+        switch (axis)
+        {
+            case 0: return {y, z, x};
+            case 1: return {x, z, y};
+            default: return {x, y, z};
+        }
+    }
+
+    static std::array<int, 3> projected_bin(const std::vector<int>& pallet_size, int axis)
+    {
+        switch (axis)
+        {
+            case 0: return {pallet_size[1], pallet_size[2], pallet_size[0]};
+            case 1: return {pallet_size[0], pallet_size[2], pallet_size[1]};
+            default: return {pallet_size[0], pallet_size[1], pallet_size[2]};
+        }
+    }
+
+    static int64_t ceil_div(int64_t a, int64_t b)
+    {
+        return a <= 0 ? 0 : (a + b - 1) / b;
+    }
+
+    static int axis_bound_l1(const std::vector<std::vector<int>>& box_dims,
+                             const std::vector<int>& pallet_size,
+                             bool allow_rotation,
+                             int axis)
+    {
+        auto bin = projected_bin(pallet_size, axis);
+        std::vector<int> depths;
+        for (const auto& dims : box_dims)
+        {
+            auto p = projected(dims, allow_rotation, axis);
+            // 두 축 모두 절반을 넘는 박스끼리는 나란히 놓일 수 없다
+            if (2 * p[0] > bin[0] && 2 * p[1] > bin[1])
+            {
+                depths.push_back(p[2]);
+            }
+        }
+        if (depths.empty())
+            return 0;
+
+        const int64_t D = bin[2];
+        std::set<int> candidates{0};
+        for (int d : depths)
+        {
+            if (2 * d <= D)
+                candidates.insert(d);
+        }
+
+        int64_t best = 0;
+        for (int p : candidates)
+        {
+            int64_t large = 0, mid = 0, mid_sum = 0, small_sum = 0;
+            for (int d : depths)
+            {
+                if (d > D - p)
+                    large++;
+                else if (2 * d > D)
+                {
+                    mid++;
+                    mid_sum += d;
+                }
+                else if (d >= p)
+                    small_sum += d;
+            }
+            int64_t bound = large + mid + ceil_div(small_sum - (mid * D - mid_sum), D);
+            best = std::max(best, bound);
+        }
+        return static_cast<int>(best);
+    }
+
+    static int axis_bound_l2(const std::vector<std::vector<int>>& box_dims,
+                             const std::vector<int>& pallet_size,
+                             bool allow_rotation,
+                             int axis)
+    {
+        int l1 = axis_bound_l1(box_dims, pallet_size, allow_rotation, axis);
+        auto bin = projected_bin(pallet_size, axis);
+        const int64_t area = static_cast<int64_t>(bin[0]) * bin[1];
+        const int64_t volume = area * bin[2];
+
+        // p <= bin[0] / 2 이므로 e[0] > bin[0] - p 이면 e[0] >= p 이다.
+        // 따라서 covered_volume 은 (e[0] >= p, e[1] >= q) 인 박스의 부피 합이고,
+        // e[1] 내림차순으로 한 번 정렬해 두면 p 마다 q 전체를 두 번의 스윕으로 구할 수 있다
+        struct Projected
+        {
+            std::array<int, 3> e;
+            int64_t volume;
+        };
+        std::vector<Projected> items;
+        items.reserve(box_dims.size());
+        std::set<int> p_values{0}, q_values{0};
+        for (const auto& dims : box_dims)
+        {
+            auto e = projected(dims, allow_rotation, axis);
+            if (2 * e[0] <= bin[0]) p_values.insert(e[0]);
+            if (2 * e[1] <= bin[1]) q_values.insert(e[1]);
+            items.push_back({e, static_cast<int64_t>(dims[0]) * dims[1] * dims[2]});
+        }
+        std::sort(items.begin(), items.end(),
+                  [](const Projected& a, const Projected& b) { return a.e[1] > b.e[1]; });
+
+        const std::vector<int> qs(q_values.begin(), q_values.end());
+        std::vector<int64_t> covered_volume(qs.size()), kv_depth(qs.size());
+
+        int64_t best = l1;
+        for (int p : p_values)
+        {
+            // q 내림차순: 임계값 e[1] >= q 가 점점 느슨해진다
+            size_t i = 0;
+            int64_t volume_sum = 0;
+            for (size_t j = qs.size(); j-- > 0;)
+            {
+                for (; i < items.size() && items[i].e[1] >= qs[j]; i++)
+                {
+                    if (items[i].e[0] >= p)
+                        volume_sum += items[i].volume;
+                }
+                covered_volume[j] = volume_sum;
+            }
+            // q 오름차순: 임계값 e[1] > bin[1] - q 가 점점 느슨해진다
+            i = 0;
+            int64_t depth_sum = 0;
+            for (size_t j = 0; j < qs.size(); j++)
+            {
+                for (; i < items.size() && items[i].e[1] > bin[1] - qs[j]; i++)
+                {
+                    if (items[i].e[0] > bin[0] - p)
+                        depth_sum += items[i].e[2];
+                }
+                kv_depth[j] = depth_sum;
+            }
+            for (size_t j = 0; j < qs.size(); j++)
+            {
+                int64_t bound = l1 + ceil_div(covered_volume[j] - (static_cast<int64_t>(bin[2]) * l1 - kv_depth[j]) * area, volume);
+                best = std::max(best, bound);
+            }
+        }
+        return static_cast<int>(best);
+    }
+};
+
+#endif
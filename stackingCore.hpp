@@ -0,0 +1,15 @@
+#ifndef _STACKING_CORE
+#define _STACKING_CORE
+
+// Placement core.
+// 표준 라이브러리(와 POSIX mmap)만 사용하므로 시각화 라이브러리 없이 빌드해 서버 등에 넣을 수 있다.
+// JSON 입출력(jsonUtils.hpp)과 시각화(stackingVisualization.hpp)는 필요한 쪽에서 따로 포함한다
+#include "stacking_algorithm.hpp"
+#include "planCache.hpp"
+#include "boxRecord.hpp"
+#include "boxSetFile.hpp"
+#include "stackResult.hpp"
+#include "resultWriter.hpp"
+#include "stackingMetrics.hpp"
+
+#endif
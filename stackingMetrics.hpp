@@ -0,0 +1,148 @@
+#ifndef _STACKING_METRICS
+#define _STACKING_METRICS
+
+#include <vector>
+#include <array>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <algorithm>
+#include <charconv>
+
+#include "boxRecord.hpp"
+#include "stackResult.hpp"
+
+// 렌더링 없이 계산하는 적재 결과 지표
+struct StackingMetrics {
+    double fill_rate = 0;                   // 메인 팔레트 적재율 (%)
+    double placed_volume = 0;               // 메인 팔레트에 놓인 박스 부피
+    int step_count = 0;                     // 처리한 배치 수
+    int main_count = 0;                     // 메인 팔레트 배치 수 (버퍼에서 옮겨 온 것 포함)
+    int buffer_count = 0;                   // 버퍼 팔레트 배치 수
+    int moved_count = 0;                    // 버퍼에서 메인으로 옮겨진 박스 수 (from_pallet == 2)
+    int missing_count = 0;                  // 박스 목록에 없는 box_id
+    std::vector<double> fill_curve;         // 메인 배치마다의 누적 적재율 (%). 시각화의 적재율 그래프와 같다
+    std::array<double, 3> center_of_gravity = {0, 0, 0};   // 메인 팔레트 박스의 무게 중심. 무게가 없는 박스가 있으면 부피 중심
+    bool weighted_center = false;           // center_of_gravity 가 무게 기준이면 true
+    double max_height = 0;                  // 메인 팔레트 최고 높이 (z + 박스 높이)
+};
+
+// Headless placement evaluator.
+// 배치를 순서대로 한 번씩만 보고 지표를 갱신하므로 시간은 배치 수에 비례한다.
+// add() 를 StackingAlgorithm::set_result_sink 에 물리면 배치가 결정되는 대로 평가할 수도 있다 (boxes 는 끝까지 살아 있어야 한다).
+// box_loc 은 바닥면 중심과 바닥 높이이고, 박스 크기는 회전과 무관한 부피와 높이만 쓴다
+class StackingEvaluator {
+public:
+    StackingEvaluator(const std::vector<BoxRecord>& boxes, const std::vector<int>& pallet_size)
+        : pallet_volume(static_cast<double>(pallet_size[0]) * pallet_size[1] * pallet_size[2])
+    {
+        box_by_id.reserve(boxes.size());
+        for (const auto& box : boxes)
+        {
+            box_by_id.emplace(box.box_id, &box);
+        }
+    }
+
+    static StackingMetrics evaluate(const std::vector<StackResult>& results,
+                                    const std::vector<BoxRecord>& boxes,
+                                    const std::vector<int>& pallet_size)
+    {
+        StackingEvaluator evaluator(boxes, pallet_size);
+        evaluator.metrics.fill_curve.reserve(results.size());
+        for (const auto& result : results)
+        {
+            evaluator.add(result);
+        }
+        return evaluator.result();
+    }
+
+    void add(const StackResult& result)
+    {
+        metrics.step_count++;
+
+        int box_id = 0;
+        const char* first = result.box_id.data();
+        const char* last = first + result.box_id.size();
+        auto parsed = std::from_chars(first, last, box_id);
+        auto it = (parsed.ec == std::errc() && parsed.ptr == last) ? box_by_id.find(box_id) : box_by_id.end();
+        if (it == box_by_id.end())
+        {
+            metrics.missing_count++;
+            return;
+        }
+        const BoxRecord& box = *it->second;
+
+        if (result.pallet_id == 2)
+        {
+            metrics.buffer_count++;
+            return;
+        }
+        if (result.pallet_id != 1)
+            return;
+
+        metrics.main_count++;
+        if (result.from_pallet == 2)
+        {
+            metrics.moved_count++;
+        }
+
+        double volume = static_cast<double>(box.box_size[0]) * box.box_size[1] * box.box_size[2];
+        double height = box.box_size[2];
+        double x = std::get<0>(result.box_loc);
+        double y = std::get<1>(result.box_loc);
+        double z = std::get<2>(result.box_loc) + height / 2;
+
+        metrics.placed_volume += volume;
+        metrics.fill_curve.push_back(rate(metrics.placed_volume));
+        metrics.max_height = std::max(metrics.max_height, std::get<2>(result.box_loc) + height);
+
+        volume_moment[0] += volume * x;
+        volume_moment[1] += volume * y;
+        volume_moment[2] += volume * z;
+        if (box.weight > 0)
+        {
+            total_weight += box.weight;
+            weight_moment[0] += box.weight * x;
+            weight_moment[1] += box.weight * y;
+            weight_moment[2] += box.weight * z;
+        }
+        else
+        {
+            all_weighted = false;
+        }
+    }
+
+    StackingMetrics result() const
+    {
+        StackingMetrics out = metrics;
+        out.fill_rate = rate(metrics.placed_volume);
+        out.weighted_center = all_weighted && total_weight > 0;
+        double mass = out.weighted_center ? total_weight : metrics.placed_volume;
+        const auto& moment = out.weighted_center ? weight_moment : volume_moment;
+        if (mass > 0)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                out.center_of_gravity[axis] = moment[axis] / mass;
+            }
+        }
+        return out;
+    }
+
+private:
+    double pallet_volume;
+    std::unordered_map<int, const BoxRecord*> box_by_id;
+    StackingMetrics metrics;
+
+    std::array<double, 3> volume_moment = {0, 0, 0};
+    std::array<double, 3> weight_moment = {0, 0, 0};
+    double total_weight = 0;
+    bool all_weighted = true;
+
+    double rate(double volume) const
+    {
+        return pallet_volume > 0 ? volume / pallet_volume * 100 : 0;
+    }
+};
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef _STACKING_VISUALIZATION
+#define _STACKING_VISUALIZATION
+
+// 적재 결과 시각화 (3D 프레임 래스터라이저, GIF/비디오, 그래프). OpenCV, gnuplot-iostream, giflib 이 필요하다
+#include "geometryTypes.hpp"
+#include "geometryUtils.hpp"
+#include "visualizationUtils.hpp"
+#include "softwareRasterizer.hpp"
+#include "frameStateLog.hpp"
+#include "paletteQuantizer.hpp"
+#include "animationWriter.hpp"
+#include "stackingVisualizer.hpp"
+
+#endif
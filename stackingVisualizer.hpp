@@ -5,1704 +5,502 @@
 #include <filesystem>
 #include <vector>
 #include <string>
-#include <map>
 #include <tuple>
 #include <algorithm>
 #include <cmath>
 #include <thread>
 #include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <unordered_map>
 
 #include <nlohmann/json.hpp>
 #include <gnuplot-iostream.h>
 #include <opencv2/opencv.hpp>
 #include <gif_lib.h>
 
+#include "geometryTypes.hpp"
 #include "geometryUtils.hpp"
 #include "visualizationUtils.hpp"
+#include "softwareRasterizer.hpp"
+#include "frameStateLog.hpp"
+#include "threadPool.hpp"
+#include "paletteQuantizer.hpp"
+#include "gifEncoder.hpp"
+#include "animationWriter.hpp"
+
+// 애니메이션 프레임 안의 3D 그림 하나
+struct ViewPanel {
+    int pallet_id;          // FrameStateLog::MAIN_PALLET / BUFFER_PALLET
+    std::string title;
+    int view1;              // gnuplot "set view view1, view2"
+    int view2;
+    double origin_x;        // gnuplot set origin / set size 처럼 왼쪽 아래 기준 비율
+    double origin_y;
+    double size_x;
+    double size_y;
+};
 
-class StackingVisualizer {
-public:
-    static std::pair<double, int> optimized_stack_check_and_visualize(
-        const std::vector<nlohmann::json>& placements,
-        const std::vector<nlohmann::json>& boxes,
-        const std::vector<double>& cubic_range,
-        const std::string& result_folder_name = "./results",
-        const std::string& result_file_name = "stacking_animation")
-    {
-        // 결과 디렉토리 초기화
-        std::filesystem::path result_path(result_folder_name);
-        try {
-            if (std::filesystem::exists(result_path))
-            {
-                std::filesystem::remove_all(result_path);
-            }
-            std::filesystem::create_directories(result_path);
-            std::cout << "Created result directory: " << std::filesystem::absolute(result_path) << std::endl;
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error handling result directory: " << e.what() << std::endl;
-            return {0.0, 0};
-        }
-
-        double total_volume = 0;
-        int stacking_number = 0;
-        std::vector<double> stacking_rates;
-        std::vector<std::string> frame_filenames;
-        bool is_valid = true;
-
-        // 각 프레임별 상태를 추적하기 위한 맵
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> main_states;
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> buffer_states;
-
-        // Initialize Gnuplot
-        Gnuplot gp;
-        gp << "set terminal pngcairo size 1600,800 enhanced font 'Verdana,10'\n";
-        
-        // 먼저 모든 placement를 순서대로 처리하여 상태 맵 구성
-        for (const auto& place_box : placements)
-        {
-            int box_id = place_box["box_id"].get<int>();
-            int pallet_id = place_box["pallet_id"].get<int>();
-            
-            auto box_it = std::find_if(boxes.begin(), boxes.end(),
-                          [box_id](const nlohmann::json& box) {
-                return box["box_id"].get<int>() == box_id;
-            });
-            
-            if (box_it == boxes.end())
-            {
-                std::cerr << "Box with ID " << box_id << " not found." << std::endl;
-                is_valid = false;
-                continue;
-            }
-
-            double width = (*box_it)["box_size"][0].get<double>();
-            double length = (*box_it)["box_size"][1].get<double>();
-            double height = (*box_it)["box_size"][2].get<double>();
-            double angle = place_box["box_rot"].get<double>();
-            double x_center = place_box["box_loc"][0].get<double>();
-            double y_center = place_box["box_loc"][1].get<double>();
-            double z_center = place_box["box_loc"][2].get<double>();
-
-            auto rotated_corners = GeometryUtils::rotate_box_corners(x_center, y_center, width, length, angle);
-            auto placement_tuple = std::make_tuple(rotated_corners, z_center, height);
-
-            // 현재 프레임까지의 모든 상태 복사
-            if (!main_states.empty())
-            {
-                main_states[stacking_number + 1] = main_states[stacking_number];
-            }
-            if (!buffer_states.empty())
-            {
-                buffer_states[stacking_number + 1] = buffer_states[stacking_number];
-            }
-
-            if (pallet_id == 1)
-            {
-                // 메인 팔렛트에 배치
-                if (main_states.find(stacking_number + 1) == main_states.end())
-                {
-                    main_states[stacking_number + 1] = {};
-                }
-                main_states[stacking_number + 1].push_back(placement_tuple);
-                total_volume += width * length * height;
-
-                // 버퍼에서 이동한 경우, 버퍼에서 제거
-                if (!buffer_states.empty())
-                {
-                    auto& last_buffer_state = buffer_states[stacking_number];
-                    auto it = std::find_if(last_buffer_state.begin(), last_buffer_state.end(),
-                        [&](const auto& state) {
-                            const auto& corners = std::get<0>(state);
-                            const double& state_z = std::get<1>(state);
-                            const double& state_height = std::get<2>(state);
-                            
-                            // 모든 모서리 좌표, z 위치, 높이를 비교
-                            bool corners_match = true;
-                            for (size_t i = 0; i < corners.size(); ++i)
-                            {
-                                if (std::abs(corners[i][0] - rotated_corners[i][0]) > 1e-6 || std::abs(corners[i][1] - rotated_corners[i][1]) > 1e-6)
-                                {
-                                    corners_match = false;
-                                    break;
-                                }
-                            }
-                            return corners_match && std::abs(state_z - z_center) < 1e-6 && std::abs(state_height - height) < 1e-6;
-                        });
-
-                    if (it != last_buffer_state.end())
-                    {
-                        last_buffer_state.erase(it);
-                        if (buffer_states.find(stacking_number + 1) != buffer_states.end())
-                        {
-                            buffer_states[stacking_number + 1] = last_buffer_state;
-                        }
-                    }
-                }
-                double stacking_rate = (total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2])) * 100;
-                stacking_rates.push_back(stacking_rate);
-            }
-            else if (pallet_id == 2)
-            {
-                // 버퍼 팔렛트에 배치
-                if (buffer_states.find(stacking_number + 1) == buffer_states.end())
-                {
-                    buffer_states[stacking_number + 1] = {};
-                }
-                buffer_states[stacking_number + 1].push_back(placement_tuple);
-            }
-
-            stacking_number++;
-            if (!is_valid)
-                break;
-        }
-
-        // 프레임 생성
-        for (int frame = 1; frame <= stacking_number; frame++)
-        {
-            std::string frame_filename;
-
-            if (frame < 10)
-            {
-                frame_filename = (result_path / ("frame_0" + std::to_string(frame) + ".png")).string();
-            }
-            else
-            {
-                frame_filename = (result_path / ("frame_" + std::to_string(frame) + ".png")).string();
-            }
-            
-            // Set output for this frame
-            gp << "set output '" << frame_filename << "'\n";
-            
-            // Setup multiplot
-            gp << "set multiplot layout 2,2 spacing 0.1\n";
-
-            // Current states
-            const auto& current_main = main_states[frame];
-
-            // Generate all views
-            generate_view_800(gp, current_main, cubic_range, "Stack optimized: Main Pallet 60, 30", 60, 30, 0.0, 0);
-            generate_view_800(gp, current_main, cubic_range, "Stack Optimized: Main Pallet 30, 60", 30, 60, 0.5, 0);
-
-            gp << "unset multiplot\n";
-            gp.flush();
-
-            // Wait for frame to be created
-            if (wait_for_frame(frame_filename))
-            {
-                frame_filenames.push_back(frame_filename);
-                std::cout << "Created frame " << frame << "/" << stacking_number << std::endl;
-            }
-        }
-
-        // Create GIF if we have frames
-        if (!frame_filenames.empty())
-        {
-            std::string gif_filename = (result_path / (result_file_name + ".gif")).string();
-            std::cout << "\nCreating GIF: " << gif_filename << std::endl;
-            VisualizationUtils::create_gif(frame_filenames, gif_filename);
-            std::cout << "GIF creation completed" << std::endl;
-        }
-        else
-        {
-            std::cerr << "No frames were generated for GIF creation" << std::endl;
-        }
-
-        // stacking rate graph
-        std::string graph_file = (result_path / "stacking_rate_graph_optmz.png").string();
-        
-        gp << "set terminal pngcairo size 800, 800 enhanced font 'Verdana, 12'\n";
-        gp << "set output '" << graph_file << "'\n";
-        gp << "set title 'Stacking Rate Over Frames'\n";
-        gp << "set xlabel 'Frame'\n";
-        gp << "set xrange [0:" << stacking_number << "]\n";
-        gp << "set ylabel 'Stacking Rate (%)'\n";
-        gp << "set yrange [0:100]\n";
-        gp << "set grid\n";
-        gp << "plot '-' with linespoints title 'Stacking Rate (%)' lc rgb 'blue'\n";
-
-        for (size_t i = 0; i < stacking_rates.size(); ++i)
-        {
-            gp << i + 1 << " " << stacking_rates[i] << "\n";
-        }
-        gp << "e\n";
-        gp.flush();
-
-        std::cout << "Stacking rate graph saved to: " << graph_file << std::endl;
-
-        return {total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2]) * 100, stacking_number};
-    }
-
-    static std::pair<double, int> optimized_stack_check_and_visualize_1600(
-        const std::vector<nlohmann::json>& placements,
-        const std::vector<nlohmann::json>& boxes,
-        const std::vector<double>& cubic_range,
-        const std::string& result_folder_name = "./results",
-        const std::string& result_file_name = "stacking_animation")
-    {
-        // 결과 디렉토리 초기화
-        std::filesystem::path result_path(result_folder_name);
-        try {
-            if (std::filesystem::exists(result_path))
-            {
-                std::filesystem::remove_all(result_path);
-            }
-            std::filesystem::create_directories(result_path);
-            std::cout << "Created result directory: " << std::filesystem::absolute(result_path) << std::endl;
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error handling result directory: " << e.what() << std::endl;
-            return {0.0, 0};
-        }
-
-        double total_volume = 0;
-        int stacking_number = 0;
-        std::vector<double> stacking_rates;
-        std::vector<std::string> frame_filenames;
-        bool is_valid = true;
-
-        // 각 프레임별 상태를 추적하기 위한 맵
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> main_states;
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> buffer_states;
-
-        // Initialize Gnuplot
-        Gnuplot gp;
-        gp << "set terminal pngcairo size 1600,1600 enhanced font 'Verdana,10'\n";
-        
-        // 먼저 모든 placement를 순서대로 처리하여 상태 맵 구성
-        for (const auto& place_box : placements)
-        {
-            int box_id = place_box["box_id"].get<int>();
-            int pallet_id = place_box["pallet_id"].get<int>();
-            
-            auto box_it = std::find_if(boxes.begin(), boxes.end(),
-                          [box_id](const nlohmann::json& box) {
-                return box["box_id"].get<int>() == box_id;
-            });
-            
-            if (box_it == boxes.end())
-            {
-                std::cerr << "Box with ID " << box_id << " not found." << std::endl;
-                is_valid = false;
-                continue;
-            }
-
-            double width = (*box_it)["box_size"][0].get<double>();
-            double length = (*box_it)["box_size"][1].get<double>();
-            double height = (*box_it)["box_size"][2].get<double>();
-            double angle = place_box["box_rot"].get<double>();
-            double x_center = place_box["box_loc"][0].get<double>();
-            double y_center = place_box["box_loc"][1].get<double>();
-            double z_center = place_box["box_loc"][2].get<double>();
-
-            auto rotated_corners = GeometryUtils::rotate_box_corners(x_center, y_center, width, length, angle);
-            auto placement_tuple = std::make_tuple(rotated_corners, z_center, height);
-
-            // 현재 프레임까지의 모든 상태 복사
-            if (!main_states.empty())
-            {
-                main_states[stacking_number + 1] = main_states[stacking_number];
-            }
-            if (!buffer_states.empty())
-            {
-                buffer_states[stacking_number + 1] = buffer_states[stacking_number];
-            }
-
-            if (pallet_id == 1)
-            {
-                // 메인 팔렛트에 배치
-                if (main_states.find(stacking_number + 1) == main_states.end())
-                {
-                    main_states[stacking_number + 1] = {};
-                }
-                main_states[stacking_number + 1].push_back(placement_tuple);
-                total_volume += width * length * height;
-
-                // 버퍼에서 이동한 경우, 버퍼에서 제거
-                if (!buffer_states.empty())
-                {
-                    auto& last_buffer_state = buffer_states[stacking_number];
-                    auto it = std::find_if(last_buffer_state.begin(), last_buffer_state.end(),
-                        [&](const auto& state) {
-                            const auto& corners = std::get<0>(state);
-                            const double& state_z = std::get<1>(state);
-                            const double& state_height = std::get<2>(state);
-                            
-                            // 모든 모서리 좌표, z 위치, 높이를 비교
-                            bool corners_match = true;
-                            for (size_t i = 0; i < corners.size(); ++i)
-                            {
-                                if (std::abs(corners[i][0] - rotated_corners[i][0]) > 1e-6 ||
-                                    std::abs(corners[i][1] - rotated_corners[i][1]) > 1e-6) {
-                                    corners_match = false;
-                                    break;
-                                }
-                            }
-                            return corners_match && 
-                                std::abs(state_z - z_center) < 1e-6 && 
-                                std::abs(state_height - height) < 1e-6;
-                        });
-
-                    if (it != last_buffer_state.end())
-                    {
-                        last_buffer_state.erase(it);
-                        if (buffer_states.find(stacking_number + 1) != buffer_states.end())
-                        {
-                            buffer_states[stacking_number + 1] = last_buffer_state;
-                        }
-                    }
-                }
-                double stacking_rate = (total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2])) * 100;
-                stacking_rates.push_back(stacking_rate);
-            }
-            else if (pallet_id == 2)
-            {
-                // 버퍼 팔렛트에 배치
-                if (buffer_states.find(stacking_number + 1) == buffer_states.end())
-                {
-                    buffer_states[stacking_number + 1] = {};
-                }
-                buffer_states[stacking_number + 1].push_back(placement_tuple);
-            }
-
-            stacking_number++;
-            if (!is_valid)
-                break;
-        }
-
-        // 프레임 생성
-        for (int frame = 1; frame <= stacking_number; frame++)
-        {
-            std::string frame_filename;
-
-            if (frame < 10)
-            {
-                frame_filename = (result_path / ("frame_0" + std::to_string(frame) + ".png")).string();
-            }
-            else
-            {
-                frame_filename = (result_path / ("frame_" + std::to_string(frame) + ".png")).string();
-            }
-            
-            // Set output for this frame
-            gp << "set output '" << frame_filename << "'\n";
-            
-            // Setup multiplot
-            gp << "set multiplot layout 2,2 spacing 0.1\n";
-
-            // Current states
-            const auto& current_main = main_states[frame];
-            const auto& current_buffer = buffer_states[frame];
-
-            // Generate all views
-            generate_view_1600(gp, current_buffer, cubic_range, "Stack optimized: Buffer Pallet 60, 30", 60, 30, 0.0, 0);
-            generate_view_1600(gp, current_buffer, cubic_range, "Stack Optimized: Buffer Pallet 30, 60", 30, 60, 0.5, 0);
-            generate_view_1600(gp, current_main, cubic_range, "Stack optimized: Main Pallet 60, 30", 60, 30, 0.0, 0.5);
-            generate_view_1600(gp, current_main, cubic_range, "Stack Optimized: Main Pallet 30, 60", 30, 60, 0.5, 0.5);
-
-            gp << "unset multiplot\n";
-            gp.flush();
-
-            // Wait for frame to be created
-            if (wait_for_frame(frame_filename))
-            {
-                frame_filenames.push_back(frame_filename);
-                std::cout << "Created frame " << frame << "/" << stacking_number << std::endl;
-            }
-        }
-
-        // Create GIF if we have frames
-        if (!frame_filenames.empty())
-        {
-            std::string gif_filename = (result_path / (result_file_name + ".gif")).string();
-            std::cout << "\nCreating GIF: " << gif_filename << std::endl;
-            VisualizationUtils::create_gif(frame_filenames, gif_filename);
-            std::cout << "GIF creation completed" << std::endl;
-        }
-        else
-        {
-            std::cerr << "No frames were generated for GIF creation" << std::endl;
-        }
-
-        return {total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2]) * 100, stacking_number};
-    }
-
-    static std::pair<double, int> optimized_stack_check_and_visualize_xyz(
-        const std::vector<nlohmann::json>& placements,
-        const std::vector<nlohmann::json>& boxes,
-        const std::vector<double>& cubic_range,
-        const std::string& result_folder_name = "./results",
-        const std::string& result_file_name = "stacking_animation")
-    {
-        // 결과 디렉토리 초기화
-        std::filesystem::path result_path(result_folder_name);
-        try {
-            if (std::filesystem::exists(result_path))
-            {
-                std::filesystem::remove_all(result_path);
-            }
-            std::filesystem::create_directories(result_path);
-            std::cout << "Created result directory: " << std::filesystem::absolute(result_path) << std::endl;
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error handling result directory: " << e.what() << std::endl;
-            return {0.0, 0};
-        }
-
-        double total_volume = 0;
-        int stacking_number = 0;
-        std::vector<double> stacking_rates;
-        std::vector<std::string> frame_filenames;
-        bool is_valid = true;
-
-        // 각 프레임별 상태를 추적하기 위한 맵
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> main_states;
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> buffer_states;
-
-        // Initialize Gnuplot
-        Gnuplot gp;
-        gp << "set terminal pngcairo size 1600,800 enhanced font 'Verdana,10'\n";
-        
-        // 먼저 모든 placement를 순서대로 처리하여 상태 맵 구성
-        for (const auto& place_box : placements)
-        {
-            int box_id = place_box["box_id"].get<int>();
-            int pallet_id = place_box["pallet_id"].get<int>();
-            
-            auto box_it = std::find_if(boxes.begin(), boxes.end(),
-                          [box_id](const nlohmann::json& box) {
-                return box["box_id"].get<int>() == box_id;
-            });
-            
-            if (box_it == boxes.end())
-            {
-                std::cerr << "Box with ID " << box_id << " not found." << std::endl;
-                is_valid = false;
-                continue;
-            }
-
-            double width = (*box_it)["box_size"][0].get<double>();
-            double length = (*box_it)["box_size"][1].get<double>();
-            double height = (*box_it)["box_size"][2].get<double>();
-            double angle = place_box["box_rot"].get<double>();
-            double x_center = place_box["box_loc"][0].get<double>();
-            double y_center = place_box["box_loc"][1].get<double>();
-            double z_center = place_box["box_loc"][2].get<double>();
-
-            auto rotated_corners = GeometryUtils::rotate_box_corners(x_center, y_center, width, length, angle);
-            auto placement_tuple = std::make_tuple(rotated_corners, z_center, height);
-
-            // 현재 프레임까지의 모든 상태 복사
-            if (!main_states.empty())
-            {
-                main_states[stacking_number + 1] = main_states[stacking_number];
-            }
-            if (!buffer_states.empty())
-            {
-                buffer_states[stacking_number + 1] = buffer_states[stacking_number];
-            }
-
-            if (pallet_id == 1)
-            {
-                // 메인 팔렛트에 배치
-                if (main_states.find(stacking_number + 1) == main_states.end())
-                {
-                    main_states[stacking_number + 1] = {};
-                }
-                main_states[stacking_number + 1].push_back(placement_tuple);
-                total_volume += width * length * height;
-
-                // 버퍼에서 이동한 경우, 버퍼에서 제거
-                if (!buffer_states.empty())
-                {
-                    auto& last_buffer_state = buffer_states[stacking_number];
-                    auto it = std::find_if(last_buffer_state.begin(), last_buffer_state.end(),
-                        [&](const auto& state) {
-                            const auto& corners = std::get<0>(state);
-                            return std::abs(corners[0][0] - rotated_corners[0][0]) < 1e-6 &&
-                                   std::abs(corners[0][1] - rotated_corners[0][1]) < 1e-6;
-                        });
-                    if (it != last_buffer_state.end())
-                    {
-                        last_buffer_state.erase(it);
-                        if (buffer_states.find(stacking_number + 1) != buffer_states.end())
-                        {
-                            buffer_states[stacking_number + 1] = last_buffer_state;
-                        }
-                    }
-                }
-                double stacking_rate = (total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2])) * 100;
-                stacking_rates.push_back(stacking_rate);
-            }
-            else if (pallet_id == 2)
-            {
-                // 버퍼 팔렛트에 배치
-                if (buffer_states.find(stacking_number + 1) == buffer_states.end())
-                {
-                    buffer_states[stacking_number + 1] = {};
-                }
-                buffer_states[stacking_number + 1].push_back(placement_tuple);
-            }
-
-            stacking_number++;
-            if (!is_valid)
-                break;
-        }
-
-        // 프레임 생성
-        for (int frame = 1; frame <= stacking_number; frame++)
-        {
-            std::string frame_filename;
-
-            if (frame < 10)
-            {
-                frame_filename = (result_path / ("frame_0" + std::to_string(frame) + ".png")).string();
-            }
-            else
-            {
-                frame_filename = (result_path / ("frame_" + std::to_string(frame) + ".png")).string();
-            }
-            
-            // Set output for this frame
-            gp << "set output '" << frame_filename << "'\n";
-            
-            // Setup multiplot
-            gp << "set multiplot layout 2,2 spacing 0.1\n";
-
-            // Current states
-            const auto& current_main = main_states[frame];
-
-            // Generate all views
-            generate_view_800(gp, current_main, cubic_range, "Stack optimized: Main Pallet x, z", 90, 0, 0.0, 0);
-            generate_view_800(gp, current_main, cubic_range, "Stack Optimized: Main Pallet x, y", 0, 90, 0.5, 0);
-
-            gp << "unset multiplot\n";
-            gp.flush();
-
-            // Wait for frame to be created
-            if (wait_for_frame(frame_filename))
-            {
-                frame_filenames.push_back(frame_filename);
-                std::cout << "Created frame " << frame << "/" << stacking_number << std::endl;
-            }
-        }
-
-        // Create GIF if we have frames
-        if (!frame_filenames.empty())
-        {
-            std::string gif_filename = (result_path / (result_file_name + ".gif")).string();
-            std::cout << "\nCreating GIF: " << gif_filename << std::endl;
-            VisualizationUtils::create_gif(frame_filenames, gif_filename);
-            std::cout << "GIF creation completed" << std::endl;
-        }
-        else
-        {
-            std::cerr << "No frames were generated for GIF creation" << std::endl;
-        }
-
-        return {total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2]) * 100, stacking_number};
-    }
-
-    static std::pair<double, int> stack_all_box_check_and_visualize(
-        const std::vector<nlohmann::json>& placements,
-        const std::vector<nlohmann::json>& boxes,
-        const std::vector<double>& cubic_range,
-        const std::string& result_folder_name = "./results",
-        const std::string& result_file_name = "stacking_animation")
-    {
-        // 결과 디렉토리 초기화
-        std::filesystem::path result_path(result_folder_name);
-        try {
-            if (std::filesystem::exists(result_path))
-            {
-                std::filesystem::remove_all(result_path);
-            }
-            std::filesystem::create_directories(result_path);
-            std::cout << "Created result directory: " << std::filesystem::absolute(result_path) << std::endl;
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error handling result directory: " << e.what() << std::endl;
-            return {0.0, 0};
-        }
-
-        double total_volume = 0;
-        int stacking_number = 0;
-        std::vector<double> stacking_rates;
-        std::vector<std::string> frame_filenames;
-        bool is_valid = true;
-
-        // 각 프레임별 상태를 추적하기 위한 맵
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> main_states;
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> buffer_states;
-
-        // Initialize Gnuplot
-        Gnuplot gp;
-        gp << "set terminal pngcairo size 1600,800 enhanced font 'Verdana,10'\n";
-        
-        // 먼저 모든 placement를 순서대로 처리하여 상태 맵 구성
-        for (const auto& place_box : placements)
-        {
-            int box_id = place_box["box_id"].get<int>();
-            int pallet_id = place_box["pallet_id"].get<int>();
-            
-            auto box_it = std::find_if(boxes.begin(), boxes.end(),
-                          [box_id](const nlohmann::json& box) {
-                return box["box_id"].get<int>() == box_id;
-            });
-            
-            if (box_it == boxes.end())
-            {
-                std::cerr << "Box with ID " << box_id << " not found." << std::endl;
-                is_valid = false;
-                continue;
-            }
-
-            double width = (*box_it)["box_size"][0].get<double>();
-            double length = (*box_it)["box_size"][1].get<double>();
-            double height = (*box_it)["box_size"][2].get<double>();
-            double angle = place_box["box_rot"].get<double>();
-            double x_center = place_box["box_loc"][0].get<double>();
-            double y_center = place_box["box_loc"][1].get<double>();
-            double z_center = place_box["box_loc"][2].get<double>();
-
-            auto rotated_corners = GeometryUtils::rotate_box_corners(x_center, y_center, width, length, angle);
-            auto placement_tuple = std::make_tuple(rotated_corners, z_center, height);
-
-            // 현재 프레임까지의 모든 상태 복사
-            if (!main_states.empty())
-            {
-                main_states[stacking_number + 1] = main_states[stacking_number];
-            }
-            if (!buffer_states.empty())
-            {
-                buffer_states[stacking_number + 1] = buffer_states[stacking_number];
-            }
-
-            if (pallet_id == 1)
-            {
-                // 메인 팔렛트에 배치
-                if (main_states.find(stacking_number + 1) == main_states.end()) {
-                    main_states[stacking_number + 1] = {};
-                }
-                main_states[stacking_number + 1].push_back(placement_tuple);
-                total_volume += width * length * height;
-
-                // 버퍼에서 이동한 경우, 버퍼에서 제거
-                if (!buffer_states.empty())
-                {
-                    auto& last_buffer_state = buffer_states[stacking_number];
-                    auto it = std::find_if(last_buffer_state.begin(), last_buffer_state.end(),
-                        [&](const auto& state) {
-                            const auto& corners = std::get<0>(state);
-                            const double& state_z = std::get<1>(state);
-                            const double& state_height = std::get<2>(state);
-                            
-                            // 모든 모서리 좌표, z 위치, 높이를 비교
-                            bool corners_match = true;
-                            for (size_t i = 0; i < corners.size(); ++i)
-                            {
-                                if (std::abs(corners[i][0] - rotated_corners[i][0]) > 1e-6 || std::abs(corners[i][1] - rotated_corners[i][1]) > 1e-6)
-                                {
-                                    corners_match = false;
-                                    break;
-                                }
-                            }
-                            return corners_match && std::abs(state_z - z_center) < 1e-6 && std::abs(state_height - height) < 1e-6;
-                        });
-
-                    if (it != last_buffer_state.end())
-                    {
-                        last_buffer_state.erase(it);
-                        if (buffer_states.find(stacking_number + 1) != buffer_states.end())
-                        {
-                            buffer_states[stacking_number + 1] = last_buffer_state;
-                        }
-                    }
-                }
-                double stacking_rate = (total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2])) * 100;
-                stacking_rates.push_back(stacking_rate);
-            }
-            else if (pallet_id == 2)
-            {
-                // 버퍼 팔렛트에 배치
-                if (buffer_states.find(stacking_number + 1) == buffer_states.end())
-                {
-                    buffer_states[stacking_number + 1] = {};
-                }
-                buffer_states[stacking_number + 1].push_back(placement_tuple);
-            }
-
-            stacking_number++;
-            if (!is_valid)
-                break;
-        }
-
-        // 프레임 생성
-        for (int frame = 1; frame <= stacking_number; frame++)
-        {
-            std::string frame_filename;
-            
-            if (frame < 10)
-            {
-                frame_filename = (result_path / ("frame_0" + std::to_string(frame) + ".png")).string();
-            }
-            else
-            {
-                frame_filename = (result_path / ("frame_" + std::to_string(frame) + ".png")).string();
-            }
-            
-            // Set output for this frame
-            gp << "set output '" << frame_filename << "'\n";
-            
-            // Setup multiplot
-            gp << "set multiplot layout 2,2 spacing 0.1\n";
-
-            // Current states
-            const auto& current_main = main_states[frame];
-
-            // Generate all views
-            generate_view_800(gp, current_main, cubic_range, "Stack all Boxes: Main Pallet 60, 30", 60, 30, 0.0, 0);
-            generate_view_800(gp, current_main, cubic_range, "Stack all Boxes: Main Pallet 30, 60", 30, 60, 0.5, 0);
-
-            gp << "unset multiplot\n";
-            gp.flush();
-
-            // Wait for frame to be created
-            if (wait_for_frame(frame_filename))
-            {
-                frame_filenames.push_back(frame_filename);
-                std::cout << "Created frame " << frame << "/" << stacking_number << std::endl;
-            }
-        }
-
-        // Create GIF if we have frames
-        if (!frame_filenames.empty())
-        {
-            std::string gif_filename = (result_path / (result_file_name + ".gif")).string();
-            std::cout << "\nCreating GIF: " << gif_filename << std::endl;
-            VisualizationUtils::create_gif(frame_filenames, gif_filename);
-            std::cout << "GIF creation completed" << std::endl;
-        }
-        else
-        {
-            std::cerr << "No frames were generated for GIF creation" << std::endl;
-        }
-
-        // stacking rate graph
-        std::string graph_file = (result_path / "stacking_rate_graph_live.png").string();
-        
-        gp << "set terminal pngcairo size 800, 800 enhanced font 'Verdana, 12'\n";
-        gp << "set output '" << graph_file << "'\n";
-        gp << "set title 'Stacking Rate Over Frames'\n";
-        gp << "set xlabel 'Frame'\n";
-        gp << "set xrange [0:" << stacking_number << "]\n";
-        gp << "set ylabel 'Stacking Rate (%)'\n";
-        gp << "set yrange [0:100]\n";
-        gp << "set grid\n";
-        gp << "plot '-' with linespoints title 'Stacking Rate (%)' lc rgb 'blue'\n";
-
-        for (size_t i = 0; i < stacking_rates.size(); ++i)
-        {
-            gp << i + 1 << " " << stacking_rates[i] << "\n";
-        }
-        gp << "e\n";
-        gp.flush();
-
-        std::cout << "Stacking rate graph saved to: " << graph_file << std::endl;
-
-        return {total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2]) * 100, stacking_number};
-    }
-
-    static std::pair<double, int> stack_all_box_check_and_visualize_1600(
-        const std::vector<nlohmann::json>& placements,
-        const std::vector<nlohmann::json>& boxes,
-        const std::vector<double>& cubic_range,
-        const std::string& result_folder_name = "./results",
-        const std::string& result_file_name = "stacking_animation")
-    {
-        // 결과 디렉토리 초기화
-        std::filesystem::path result_path(result_folder_name);
-        try {
-            if (std::filesystem::exists(result_path))
-            {
-                std::filesystem::remove_all(result_path);
-            }
-            std::filesystem::create_directories(result_path);
-            std::cout << "Created result directory: " << std::filesystem::absolute(result_path) << std::endl;
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error handling result directory: " << e.what() << std::endl;
-            return {0.0, 0};
-        }
-
-        double total_volume = 0;
-        int stacking_number = 0;
-        std::vector<double> stacking_rates;
-        std::vector<std::string> frame_filenames;
-        bool is_valid = true;
-
-        // 각 프레임별 상태를 추적하기 위한 맵
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> main_states;
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> buffer_states;
-
-        // Initialize Gnuplot
-        Gnuplot gp;
-        gp << "set terminal pngcairo size 1600,1600 enhanced font 'Verdana,10'\n";
-        
-        // 먼저 모든 placement를 순서대로 처리하여 상태 맵 구성
-        for (const auto& place_box : placements)
-        {
-            int box_id = place_box["box_id"].get<int>();
-            int pallet_id = place_box["pallet_id"].get<int>();
-            
-            auto box_it = std::find_if(boxes.begin(), boxes.end(),
-                          [box_id](const nlohmann::json& box) {
-                return box["box_id"].get<int>() == box_id;
-            });
-            
-            if (box_it == boxes.end())
-            {
-                std::cerr << "Box with ID " << box_id << " not found." << std::endl;
-                is_valid = false;
-                continue;
-            }
-
-            double width = (*box_it)["box_size"][0].get<double>();
-            double length = (*box_it)["box_size"][1].get<double>();
-            double height = (*box_it)["box_size"][2].get<double>();
-            double angle = place_box["box_rot"].get<double>();
-            double x_center = place_box["box_loc"][0].get<double>();
-            double y_center = place_box["box_loc"][1].get<double>();
-            double z_center = place_box["box_loc"][2].get<double>();
-
-            auto rotated_corners = GeometryUtils::rotate_box_corners(x_center, y_center, width, length, angle);
-            auto placement_tuple = std::make_tuple(rotated_corners, z_center, height);
-
-            // 현재 프레임까지의 모든 상태 복사
-            if (!main_states.empty())
-            {
-                main_states[stacking_number + 1] = main_states[stacking_number];
-            }
-            if (!buffer_states.empty())
-            {
-                buffer_states[stacking_number + 1] = buffer_states[stacking_number];
-            }
-
-            if (pallet_id == 1)
-            {
-                // 메인 팔렛트에 배치
-                if (main_states.find(stacking_number + 1) == main_states.end())
-                {
-                    main_states[stacking_number + 1] = {};
-                }
-                main_states[stacking_number + 1].push_back(placement_tuple);
-                total_volume += width * length * height;
-
-                // 버퍼에서 이동한 경우, 버퍼에서 제거
-                if (!buffer_states.empty())
-                {
-                    auto& last_buffer_state = buffer_states[stacking_number];
-                    auto it = std::find_if(last_buffer_state.begin(), last_buffer_state.end(),
-                        [&](const auto& state) {
-                            const auto& corners = std::get<0>(state);
-                            const double& state_z = std::get<1>(state);
-                            const double& state_height = std::get<2>(state);
-                            
-                            // 모든 모서리 좌표, z 위치, 높이를 비교
-                            bool corners_match = true;
-                            for (size_t i = 0; i < corners.size(); ++i)
-                            {
-                                if (std::abs(corners[i][0] - rotated_corners[i][0]) > 1e-6 || std::abs(corners[i][1] - rotated_corners[i][1]) > 1e-6)
-                                {
-                                    corners_match = false;
-                                    break;
-                                }
-                            }
-                            return corners_match && std::abs(state_z - z_center) < 1e-6 && std::abs(state_height - height) < 1e-6;
-                        });
-
-                    if (it != last_buffer_state.end())
-                    {
-                        last_buffer_state.erase(it);
-                        if (buffer_states.find(stacking_number + 1) != buffer_states.end())
-                        {
-                            buffer_states[stacking_number + 1] = last_buffer_state;
-                        }
-                    }
-                }
-                double stacking_rate = (total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2])) * 100;
-                stacking_rates.push_back(stacking_rate);
-            }
-            else if (pallet_id == 2)
-            {
-                // 버퍼 팔렛트에 배치
-                if (buffer_states.find(stacking_number + 1) == buffer_states.end())
-                {
-                    buffer_states[stacking_number + 1] = {};
-                }
-                buffer_states[stacking_number + 1].push_back(placement_tuple);
-            }
-
-            stacking_number++;
-            if (!is_valid)
-                break;
-        }
-
-        // 프레임 생성
-        for (int frame = 1; frame <= stacking_number; frame++)
-        {
-            std::string frame_filename;
-            
-            if (frame < 10)
-            {
-                frame_filename = (result_path / ("frame_0" + std::to_string(frame) + ".png")).string();
-            }
-            else
-            {
-                frame_filename = (result_path / ("frame_" + std::to_string(frame) + ".png")).string();
-            }
-            
-            // Set output for this frame
-            gp << "set output '" << frame_filename << "'\n";
-            
-            // Setup multiplot
-            gp << "set multiplot layout 2,2 spacing 0.1\n";
-
-            // Current states
-            const auto& current_main = main_states[frame];
-            const auto& current_buffer = buffer_states[frame];
-
-            // Generate all views
-            generate_view_1600(gp, current_buffer, cubic_range, "Stack all Boxes: Buffer Pallet 60, 30", 60, 30, 0.0, 0);
-            generate_view_1600(gp, current_buffer, cubic_range, "Stack all Boxes: Buffer Pallet 30, 60", 30, 60, 0.5, 0);
-            generate_view_1600(gp, current_main, cubic_range, "Stack all Boxes: Main Pallet 60, 30", 60, 30, 0.0, 0.5);
-            generate_view_1600(gp, current_main, cubic_range, "Stack all Boxes: Main Pallet 30, 60", 30, 60, 0.5, 0.5);
-
-            gp << "unset multiplot\n";
-            gp.flush();
-
-            // Wait for frame to be created
-            if (wait_for_frame(frame_filename))
-            {
-                frame_filenames.push_back(frame_filename);
-                std::cout << "Created frame " << frame << "/" << stacking_number << std::endl;
-            }
-        }
-
-        // Create GIF if we have frames
-        if (!frame_filenames.empty())
-        {
-            std::string gif_filename = (result_path / (result_file_name + ".gif")).string();
-            std::cout << "\nCreating GIF: " << gif_filename << std::endl;
-            VisualizationUtils::create_gif(frame_filenames, gif_filename);
-            std::cout << "GIF creation completed" << std::endl;
-        }
-        else
-        {
-            std::cerr << "No frames were generated for GIF creation" << std::endl;
-        }
+// 애니메이션 파일 하나 (result_folder/result_file_name + .gif 또는 video_codec.extension)
+struct AnimationOutput {
+    std::string result_folder = "./results";
+    std::string result_file_name = "stacking_animation";
+    cv::Size frame_size = cv::Size(1600, 800);
+    std::vector<ViewPanel> panels;
+    std::string rate_graph_file;        // 비어 있지 않으면 result_folder 에 적재율 그래프도 그린다
+    bool save_frames = false;           // frame_XX.png 도 남긴다
+    AnimationFormat format = AnimationFormat::GIF;
+    double fps = 10;
+    bool adaptive_palette = false;      // GIF 만
+    VideoCodec video_codec;             // VIDEO 만
+};
 
-        return {total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2]) * 100, stacking_number};
-    }
+struct VisualizationConfig {
+    std::vector<AnimationOutput> outputs;
+    bool show_move_source = false;      // 옮기기 전 버퍼에 있는 모습을 한 프레임 먼저 보여 준다
+};
 
-    static std::pair<double, int> stack_all_box_check_and_visualize_xyz(
+class StackingVisualizer {
+public:
+    // placements 를 한 번 훑어 프레임 상태를 만들고, 모든 출력의 프레임을 한 번의 렌더링 루프에서 그린다.
+    // 반환값은 (최종 적재율 %, 프레임 수)
+    static std::pair<double, int> visualize(
         const std::vector<nlohmann::json>& placements,
         const std::vector<nlohmann::json>& boxes,
         const std::vector<double>& cubic_range,
-        const std::string& result_folder_name = "./results",
-        const std::string& result_file_name = "stacking_animation")
+        const VisualizationConfig& config)
     {
         // 결과 디렉토리 초기화
-        std::filesystem::path result_path(result_folder_name);
-        try {
-            if (std::filesystem::exists(result_path))
-            {
-                std::filesystem::remove_all(result_path);
+        for (const auto& output : config.outputs)
+        {
+            std::filesystem::path result_path(output.result_folder);
+            try {
+                if (std::filesystem::exists(result_path))
+                {
+                    std::filesystem::remove_all(result_path);
+                }
+                std::filesystem::create_directories(result_path);
+                std::cout << "Created result directory: " << std::filesystem::absolute(result_path) << std::endl;
+            } catch (const std::filesystem::filesystem_error& e) {
+                std::cerr << "Error handling result directory: " << e.what() << std::endl;
+                return {0.0, 0};
             }
-            std::filesystem::create_directories(result_path);
-            std::cout << "Created result directory: " << std::filesystem::absolute(result_path) << std::endl;
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error handling result directory: " << e.what() << std::endl;
-            return {0.0, 0};
         }
 
+        // box_id -> box. placement 마다 boxes 를 다시 훑지 않는다
+        std::unordered_map<int, const nlohmann::json*> box_by_id;
+        box_by_id.reserve(boxes.size());
+        for (const auto& box : boxes)
+        {
+            box_by_id.emplace(box["box_id"].get<int>(), &box);
+        }
+
+        const double container_volume = cubic_range[0] * cubic_range[1] * cubic_range[2];
         double total_volume = 0;
-        int stacking_number = 0;
         std::vector<double> stacking_rates;
-        std::vector<std::string> frame_filenames;
-        bool is_valid = true;
 
-        // 각 프레임별 상태를 추적하기 위한 맵
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> main_states;
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> buffer_states;
+        // 프레임별 팔렛트 상태 (이벤트 로그). 모든 출력이 같이 쓴다
+        FrameStateLog state_log;
 
-        // Initialize Gnuplot
-        Gnuplot gp;
-        gp << "set terminal pngcairo size 1600,800 enhanced font 'Verdana,10'\n";
-        
-        // 먼저 모든 placement를 순서대로 처리하여 상태 맵 구성
         for (const auto& place_box : placements)
         {
             int box_id = place_box["box_id"].get<int>();
             int pallet_id = place_box["pallet_id"].get<int>();
-            
-            auto box_it = std::find_if(boxes.begin(), boxes.end(),
-                          [box_id](const nlohmann::json& box) {
-                return box["box_id"].get<int>() == box_id;
-            });
-            
-            if (box_it == boxes.end())
+
+            auto box_it = box_by_id.find(box_id);
+            if (box_it == box_by_id.end())
             {
                 std::cerr << "Box with ID " << box_id << " not found." << std::endl;
-                is_valid = false;
-                continue;
+                break;
             }
+            const auto& box = *box_it->second;
 
-            double width = (*box_it)["box_size"][0].get<double>();
-            double length = (*box_it)["box_size"][1].get<double>();
-            double height = (*box_it)["box_size"][2].get<double>();
+            double width = box["box_size"][0].get<double>();
+            double length = box["box_size"][1].get<double>();
+            double height = box["box_size"][2].get<double>();
             double angle = place_box["box_rot"].get<double>();
             double x_center = place_box["box_loc"][0].get<double>();
             double y_center = place_box["box_loc"][1].get<double>();
             double z_center = place_box["box_loc"][2].get<double>();
 
             auto rotated_corners = GeometryUtils::rotate_box_corners(x_center, y_center, width, length, angle);
-            auto placement_tuple = std::make_tuple(rotated_corners, z_center, height);
-
-            // 현재 프레임까지의 모든 상태 복사
-            if (!main_states.empty())
-            {
-                main_states[stacking_number + 1] = main_states[stacking_number];
-            }
-            if (!buffer_states.empty())
-            {
-                buffer_states[stacking_number + 1] = buffer_states[stacking_number];
-            }
+            auto placement_box = OBB{rotated_corners, z_center, height};
 
             if (pallet_id == 1)
             {
-                // 메인 팔렛트에 배치
-                if (main_states.find(stacking_number + 1) == main_states.end())
-                {
-                    main_states[stacking_number + 1] = {};
-                }
-                main_states[stacking_number + 1].push_back(placement_tuple);
-                total_volume += width * length * height;
-
-                // 버퍼에서 이동한 경우, 버퍼에서 제거
-                if (!buffer_states.empty())
+                // 메인 팔렛트에 배치. from_pallet 이 2 이면 버퍼에서 옮겨 온 박스다.
+                // from_pallet 이 없는 예전 배치 파일은 버퍼에 같은 box_id 가 있는지로 판단한다
+                bool from_buffer = place_box.contains("from_pallet")
+                    ? place_box["from_pallet"].get<int>() == FrameStateLog::BUFFER_PALLET
+                    : state_log.contains(FrameStateLog::BUFFER_PALLET, box_id);
+                if (from_buffer && state_log.contains(FrameStateLog::BUFFER_PALLET, box_id))
                 {
-                    auto& last_buffer_state = buffer_states[stacking_number];
-                    auto it = std::find_if(last_buffer_state.begin(), last_buffer_state.end(),
-                        [&](const auto& state) {
-                            const auto& corners = std::get<0>(state);
-                            return std::abs(corners[0][0] - rotated_corners[0][0]) < 1e-6 &&
-                                   std::abs(corners[0][1] - rotated_corners[0][1]) < 1e-6;
-                        });
-                    if (it != last_buffer_state.end())
+                    if (config.show_move_source)
                     {
-                        last_buffer_state.erase(it);
-                        if (buffer_states.find(stacking_number + 1) != buffer_states.end())
-                        {
-                            buffer_states[stacking_number + 1] = last_buffer_state;
-                        }
+                        std::cout << "Moved box " << box_id << " from buffer to main" << std::endl;
+                        state_log.end_frame();
                     }
+                    state_log.move(FrameStateLog::BUFFER_PALLET, FrameStateLog::MAIN_PALLET, box_id, placement_box);
+                }
+                else
+                {
+                    state_log.place(FrameStateLog::MAIN_PALLET, box_id, placement_box);
                 }
-                double stacking_rate = (total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2])) * 100;
-                stacking_rates.push_back(stacking_rate);
+                total_volume += width * length * height;
+                stacking_rates.push_back(total_volume / container_volume * 100);
             }
             else if (pallet_id == 2)
             {
                 // 버퍼 팔렛트에 배치
-                if (buffer_states.find(stacking_number + 1) == buffer_states.end())
-                {
-                    buffer_states[stacking_number + 1] = {};
-                }
-                buffer_states[stacking_number + 1].push_back(placement_tuple);
+                state_log.place(FrameStateLog::BUFFER_PALLET, box_id, placement_box);
             }
 
-            stacking_number++;
-            if (!is_valid) break;
+            state_log.end_frame();
+        }
+
+        // 프레임 생성. 프레임마다 상태가 정해져 있으므로 worker 들이 나눠서 그리고, 순서대로 바로 인코딩한다
+        for (const auto& output : config.outputs)
+        {
+            std::cout << "\nCreating animation: " << animation_filename(output) << std::endl;
         }
+        std::vector<int> rendered_frames = render_frames(config.outputs, state_log, cubic_range);
 
-        // 프레임 생성
-        for (int frame = 1; frame <= stacking_number; frame++) 
+        for (size_t i = 0; i < config.outputs.size(); i++)
         {
-            std::string frame_filename;
-            
-            if (frame < 10)
+            const auto& output = config.outputs[i];
+            if (rendered_frames[i] > 0)
             {
-                frame_filename = (result_path / ("frame_0" + std::to_string(frame) + ".png")).string();
+                std::cout << "Animation creation completed: " << animation_filename(output) << std::endl;
             }
             else
             {
-                frame_filename = (result_path / ("frame_" + std::to_string(frame) + ".png")).string();
+                std::cerr << "No frames were generated for animation: " << animation_filename(output) << std::endl;
             }
-            
-            // Set output for this frame
-            gp << "set output '" << frame_filename << "'\n";
-            
-            // Setup multiplot
-            gp << "set multiplot layout 2,2 spacing 0.1\n";
-
-            // Current states
-            const auto& current_main = main_states[frame];
-
-            // Generate all views
-            generate_view_800(gp, current_main, cubic_range, "Stack all Boxes: Main Pallet x, z", 90, 0, 0.0, 0);
-            generate_view_800(gp, current_main, cubic_range, "Stack all Boxes: Main Pallet x, y", 0, 90, 0.5, 0);
 
-            gp << "unset multiplot\n";
-            gp.flush();
-
-            // Wait for frame to be created
-            if (wait_for_frame(frame_filename))
+            if (!output.rate_graph_file.empty())
             {
-                frame_filenames.push_back(frame_filename);
-                std::cout << "Created frame " << frame << "/" << stacking_number << std::endl;
+                std::string graph_file = (std::filesystem::path(output.result_folder) / output.rate_graph_file).string();
+                write_rate_graph(graph_file, stacking_rates, state_log.frame_count());
             }
         }
 
-        // Create GIF if we have frames
-        if (!frame_filenames.empty())
-        {
-            std::string gif_filename = (result_path / (result_file_name + ".gif")).string();
-            std::cout << "\nCreating GIF: " << gif_filename << std::endl;
-            VisualizationUtils::create_gif(frame_filenames, gif_filename);
-            std::cout << "GIF creation completed" << std::endl;
-        }
-        else
-        {
-            std::cerr << "No frames were generated for GIF creation" << std::endl;
-        }
-
-        return {total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2]) * 100, stacking_number};
+        return {total_volume / container_volume * 100, state_log.frame_count()};
     }
 
-    static std::pair<double, int> stack_with_buffer_check_and_visualize(
-        const std::vector<nlohmann::json>& placements,
-        const std::vector<nlohmann::json>& boxes,
-        const std::vector<double>& cubic_range,
-        const std::string& result_folder_name = "./results",
-        const std::string& result_file_name = "stacking_animation")
+    // 메인 팔렛트를 60, 30 / 30, 60 에서 본 두 그림 (1600x800)
+    static AnimationOutput main_pallet_output(const std::string& result_folder_name,
+                                              const std::string& result_file_name,
+                                              const std::string& label)
     {
-        // Initialize result directory
-        std::filesystem::path result_path(result_folder_name);
-        try {
-            if (std::filesystem::exists(result_path))
-            {
-                std::filesystem::remove_all(result_path);
-            }
-            std::filesystem::create_directories(result_path);
-            std::cout << "Created result directory: " << std::filesystem::absolute(result_path) << std::endl;
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error handling result directory: " << e.what() << std::endl;
-            return {0.0, 0};
-        }
-
-        // stack_with_buffer_check_and_visualize 메소드 내의 메인 처리 부분을 다음과 같이 수정
+        AnimationOutput output;
+        output.result_folder = result_folder_name;
+        output.result_file_name = result_file_name;
+        output.frame_size = cv::Size(1600, 800);
+        output.panels = {
+            {FrameStateLog::MAIN_PALLET, label + ": Main Pallet 60, 30", 60, 30, 0.0, 0.0, 0.5, 1.0},
+            {FrameStateLog::MAIN_PALLET, label + ": Main Pallet 30, 60", 30, 60, 0.5, 0.0, 0.5, 1.0}
+        };
+        return output;
+    }
 
-        double total_volume = 0;
-        int frame_number = 0;
-        std::vector<double> stacking_rates;
-        std::vector<std::string> frame_filenames;
-        bool is_valid = true;
+    // 위: 버퍼 팔렛트, 아래: 메인 팔렛트를 각각 60, 30 / 30, 60 에서 본 네 그림 (1600x1600)
+    static AnimationOutput both_pallets_output(const std::string& result_folder_name,
+                                               const std::string& result_file_name,
+                                               const std::string& label)
+    {
+        AnimationOutput output;
+        output.result_folder = result_folder_name;
+        output.result_file_name = result_file_name;
+        output.frame_size = cv::Size(1600, 1600);
+        output.panels = {
+            {FrameStateLog::BUFFER_PALLET, label + ": Buffer Pallet 60, 30", 60, 30, 0.0, 0.0, 0.5, 0.5},
+            {FrameStateLog::BUFFER_PALLET, label + ": Buffer Pallet 30, 60", 30, 60, 0.5, 0.0, 0.5, 0.5},
+            {FrameStateLog::MAIN_PALLET, label + ": Main Pallet 60, 30", 60, 30, 0.0, 0.5, 0.5, 0.5},
+            {FrameStateLog::MAIN_PALLET, label + ": Main Pallet 30, 60", 30, 60, 0.5, 0.5, 0.5, 0.5}
+        };
+        return output;
+    }
 
-        std::vector<std::tuple<std::vector<std::vector<double>>, double, double>> main_state;
-        std::vector<std::tuple<std::vector<std::vector<double>>, double, double>> buffer_state;
+    // 메인 팔렛트의 x-z 정면과 x-y 평면 (1600x800)
+    static AnimationOutput main_pallet_xyz_output(const std::string& result_folder_name,
+                                                  const std::string& result_file_name,
+                                                  const std::string& label)
+    {
+        AnimationOutput output;
+        output.result_folder = result_folder_name;
+        output.result_file_name = result_file_name;
+        output.frame_size = cv::Size(1600, 800);
+        output.panels = {
+            {FrameStateLog::MAIN_PALLET, label + ": Main Pallet x, z", 90, 0, 0.0, 0.0, 0.5, 1.0},
+            {FrameStateLog::MAIN_PALLET, label + ": Main Pallet x, y", 0, 90, 0.5, 0.0, 0.5, 1.0}
+        };
+        return output;
+    }
 
-        // Initialize Gnuplot
-        Gnuplot gp;
-        gp << "set terminal pngcairo size 1600,1600 enhanced font 'Verdana,10'\n";
+private:
+    static std::string animation_basename(const AnimationOutput& output)
+    {
+        return (std::filesystem::path(output.result_folder) / output.result_file_name).string();
+    }
 
-        auto create_frame = [&](const std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>& current_main,
-                            const std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>& current_buffer) {
-            frame_number++;
-            std::string frame_filename = (frame_number < 10) ?
-                (result_path / ("frame_0" + std::to_string(frame_number) + ".png")).string()
-                : (result_path / ("frame_" + std::to_string(frame_number) + ".png")).string();
-            
-            gp << "set output '" << frame_filename << "'\n";
-            gp << "set multiplot layout 2,2 spacing 0.1\n";
+    static std::string animation_filename(const AnimationOutput& output)
+    {
+        return AnimationWriter::filename_for(animation_basename(output), output.format, output.video_codec);
+    }
 
-            generate_view_1600(gp, current_buffer, cubic_range, "Stack with Buffer: Buffer Pallet 60, 30", 60, 30, 0.0, 0);
-            generate_view_1600(gp, current_buffer, cubic_range, "Stack with Buffer: Buffer Pallet 30, 60", 30, 60, 0.5, 0);
-            generate_view_1600(gp, current_main, cubic_range, "Stack with Buffer: Main Pallet 60, 30", 60, 30, 0.0, 0.5);
-            generate_view_1600(gp, current_main, cubic_range, "Stack with Buffer: Main Pallet 30, 60", 30, 60, 0.5, 0.5);
+    static std::string frame_filename(const std::filesystem::path& result_path, int frame)
+    {
+        return (frame < 10)
+            ? (result_path / ("frame_0" + std::to_string(frame) + ".png")).string()
+            : (result_path / ("frame_" + std::to_string(frame) + ".png")).string();
+    }
 
-            gp << "unset multiplot\n";
-            gp.flush();
+    // state_log 의 프레임을 출력마다 그려서 순서대로 각자의 GIF/비디오에 인코딩하고, 출력별로 인코딩된 프레임 수를 돌려준다.
+    // 프레임 상태는 worker 의 Cursor 하나로 한 번만 재생하고 모든 출력이 같이 쓴다.
+    // worker 들은 다음 프레임 번호를 하나씩 가져가 창(window) 안의 슬롯에 그리고, 호출한 스레드가 슬롯을
+    // 프레임 순서대로 꺼내 인코더에 넣는다. 슬롯은 worker 수의 두 배라 메모리에 있는 프레임 수는 고정이다.
+    // 프레임 번호를 오름차순으로 가져가므로 worker 마다 Cursor 하나를 앞으로만 진행시키면 된다.
+    // save_frames 인 출력은 worker 가 frame_XX.png 도 남긴다.
+    // adaptive_palette 인 GIF 출력은 박스가 가장 많은 마지막 프레임을 먼저 한 번 그려서 애니메이션 전체의 팔레트를 만든다
+    static std::vector<int> render_frames(const std::vector<AnimationOutput>& outputs,
+                                          const FrameStateLog& state_log,
+                                          const std::vector<double>& cubic_range)
+    {
+        const int frame_count = state_log.frame_count();
+        std::vector<int> encoded(outputs.size(), 0);
+        if (frame_count == 0 || outputs.empty())
+            return encoded;
 
-            if (wait_for_frame(frame_filename))
+        auto blank_images = [&]() {
+            std::vector<cv::Mat> images;
+            for (const auto& output : outputs)
             {
-                frame_filenames.push_back(frame_filename);
-                std::cout << "Created frame " << frame_number << std::endl;
+                images.emplace_back(output.frame_size.height, output.frame_size.width, CV_8UC3, cv::Scalar(255, 255, 255));
             }
+            return images;
         };
-
-        // Process placements and create frames
-        for (const auto& place_box : placements)
-        {
-            int box_id = place_box["box_id"].get<int>();
-            int pallet_id = place_box["pallet_id"].get<int>();
-            
-            auto box_it = std::find_if(boxes.begin(), boxes.end(),
-                [box_id](const nlohmann::json& box) {
-                    return box["box_id"].get<int>() == box_id;
-                });
-            
-            if (box_it == boxes.end())
+        auto draw_output = [&](SoftwareRasterizer& rasterizer, const FrameStateLog::Cursor& states, const AnimationOutput& output, cv::Mat& frame_image) {
+            for (const auto& panel : output.panels)
             {
-                std::cerr << "Box with ID " << box_id << " not found." << std::endl;
-                is_valid = false;
-                continue;
+                draw_panel(rasterizer, frame_image, panel, states.state(panel.pallet_id), cubic_range);
             }
+        };
 
-            double width = (*box_it)["box_size"][0].get<double>();
-            double length = (*box_it)["box_size"][1].get<double>();
-            double height = (*box_it)["box_size"][2].get<double>();
-            double angle = place_box["box_rot"].get<double>();
-            double x_center = place_box["box_loc"][0].get<double>();
-            double y_center = place_box["box_loc"][1].get<double>();
-            double z_center = place_box["box_loc"][2].get<double>();
-
-            auto rotated_corners = GeometryUtils::rotate_box_corners(x_center, y_center, width, length, angle);
-            auto placement_tuple = std::make_tuple(rotated_corners, z_center, height);
-
-            if (pallet_id == 1)
+        std::vector<AnimationWriter> writers(outputs.size());
+        {
+            SoftwareRasterizer rasterizer;
+            FrameStateLog::Cursor states(state_log);
+            states.seek(frame_count);
+            for (size_t i = 0; i < outputs.size(); i++)
             {
-                // Check if this box is coming from buffer
-                auto it = std::find_if(buffer_state.begin(), buffer_state.end(),
-                    [&](const auto& state) {
-                        const auto& corners = std::get<0>(state);
-                        bool corners_match = true;
-                        for (size_t i = 0; i < corners.size(); ++i)
-                        {
-                            if (std::abs(corners[i][0] - rotated_corners[i][0]) > 1e-6 || std::abs(corners[i][1] - rotated_corners[i][1]) > 1e-6)
-                            {
-                                corners_match = false;
-                                break;
-                            }
-                        }
-                        return corners_match;
-                    });
-
-                if (it != buffer_state.end())
+                PaletteQuantizer quantizer = PaletteQuantizer::fixed();
+                if (outputs[i].format == AnimationFormat::GIF && outputs[i].adaptive_palette)
                 {
-                    std::cout << "Moved box " << box_id << " from buffer to main" << std::endl;
-                    
-                    // Create frame showing box still in buffer
-                    create_frame(main_state, buffer_state);
-                    
-                    // Update states and create frame showing the moved box
-                    main_state.push_back(placement_tuple);
-                    buffer_state.erase(it);
-                    create_frame(main_state, buffer_state);
+                    cv::Mat sample(outputs[i].frame_size.height, outputs[i].frame_size.width, CV_8UC3, cv::Scalar(255, 255, 255));
+                    draw_output(rasterizer, states, outputs[i], sample);
+                    quantizer = PaletteQuantizer::adaptive(sample);
                 }
-                else
+                writers[i].open(animation_basename(outputs[i]), outputs[i].format, outputs[i].frame_size,
+                                outputs[i].fps, outputs[i].video_codec, quantizer);
+            }
+        }
+
+        auto render_one = [&](SoftwareRasterizer& rasterizer, FrameStateLog::Cursor& states, std::vector<cv::Mat>& images, int frame) {
+            states.seek(frame);
+            for (size_t i = 0; i < outputs.size(); i++)
+            {
+                draw_output(rasterizer, states, outputs[i], images[i]);
+                if (outputs[i].save_frames)
                 {
-                    // For boxes directly placed in main pallet, create only one frame
-                    main_state.push_back(placement_tuple);
-                    create_frame(main_state, buffer_state);
+                    write_frame(frame_filename(outputs[i].result_folder, frame), images[i]);
                 }
-                
-                total_volume += width * length * height;
-                double stacking_rate = (total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2])) * 100;
-                stacking_rates.push_back(stacking_rate);
             }
-            else if (pallet_id == 2)
+        };
+        auto encode = [&](const std::vector<cv::Mat>& images, int frame) {
+            bool added = false;
+            for (size_t i = 0; i < outputs.size(); i++)
             {
-                // For boxes placed in buffer, create only one frame
-                buffer_state.push_back(placement_tuple);
-                create_frame(main_state, buffer_state);
+                added = writers[i].add_frame(images[i]) || added;
             }
-
-            if (!is_valid) break;
-        }
-
-        // Create GIF if we have frames
-        if (!frame_filenames.empty())
-        {
-            std::string gif_filename = (result_path / (result_file_name + ".gif")).string();
-            std::cout << "\nCreating GIF: " << gif_filename << std::endl;
-            VisualizationUtils::create_gif(frame_filenames, gif_filename);
-            std::cout << "GIF creation completed" << std::endl;
-        }
-        else
-        {
-            std::cerr << "No frames were generated for GIF creation" << std::endl;
-        }
-
-        // stacking rate graph
-        std::string graph_file = (result_path / "stacking_rate_graph_buf.png").string();
-        
-        gp << "set terminal pngcairo size 800, 800 enhanced font 'Verdana, 12'\n";
-        gp << "set output '" << graph_file << "'\n";
-        gp << "set title 'Stacking Rate Over Frames'\n";
-        gp << "set xlabel 'Frame'\n";
-        gp << "set xrange [0:" << frame_number << "]\n";
-        gp << "set ylabel 'Stacking Rate (%)'\n";
-        gp << "set yrange [0:100]\n";
-        gp << "set grid\n";
-        gp << "plot '-' with linespoints title 'Stacking Rate (%)' lc rgb 'blue'\n";
-
-        for (size_t i = 0; i < stacking_rates.size(); ++i)
-        {
-            gp << i + 1 << " " << stacking_rates[i] << "\n";
-        }
-        gp << "e\n";
-        gp.flush();
-
-        std::cout << "Stacking rate graph saved to: " << graph_file << std::endl;
-
-        return {total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2]) * 100, frame_number};
-    }
-
-    static std::pair<double, int> stack_with_buffer_check_and_visualize_xyz(
-        const std::vector<nlohmann::json>& placements,
-        const std::vector<nlohmann::json>& boxes,
-        const std::vector<double>& cubic_range,
-        const std::string& result_folder_name = "./results",
-        const std::string& result_file_name = "stacking_animation")
-    {
-        // 결과 디렉토리 초기화
-        std::filesystem::path result_path(result_folder_name);
-        try {
-            if (std::filesystem::exists(result_path))
+            if (added)
             {
-                std::filesystem::remove_all(result_path);
+                std::cout << "Created frame " << frame << "/" << frame_count << std::endl;
             }
-            std::filesystem::create_directories(result_path);
-            std::cout << "Created result directory: " << std::filesystem::absolute(result_path) << std::endl;
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error handling result directory: " << e.what() << std::endl;
-            return {0.0, 0};
-        }
-
-        double total_volume = 0;
-        int stacking_number = 0;
-        std::vector<double> stacking_rates;
-        std::vector<std::string> frame_filenames;
-        bool is_valid = true;
-
-        // 각 프레임별 상태를 추적하기 위한 맵
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> main_states;
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>> buffer_states;
+        };
 
-        // Initialize Gnuplot
-        Gnuplot gp;
-        gp << "set terminal pngcairo size 1600,800 enhanced font 'Verdana,10'\n";
-        
-        // 먼저 모든 placement를 순서대로 처리하여 상태 맵 구성
-        for (const auto& place_box : placements)
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        if (threads == 1 || frame_count == 1)
         {
-            int box_id = place_box["box_id"].get<int>();
-            int pallet_id = place_box["pallet_id"].get<int>();
-            
-            auto box_it = std::find_if(boxes.begin(), boxes.end(),
-                          [box_id](const nlohmann::json& box) {
-                return box["box_id"].get<int>() == box_id;
-            });
-            
-            if (box_it == boxes.end())
-            {
-                std::cerr << "Box with ID " << box_id << " not found." << std::endl;
-                is_valid = false;
-                continue;
-            }
-
-            double width = (*box_it)["box_size"][0].get<double>();
-            double length = (*box_it)["box_size"][1].get<double>();
-            double height = (*box_it)["box_size"][2].get<double>();
-            double angle = place_box["box_rot"].get<double>();
-            double x_center = place_box["box_loc"][0].get<double>();
-            double y_center = place_box["box_loc"][1].get<double>();
-            double z_center = place_box["box_loc"][2].get<double>();
-
-            auto rotated_corners = GeometryUtils::rotate_box_corners(x_center, y_center, width, length, angle);
-            auto placement_tuple = std::make_tuple(rotated_corners, z_center, height);
-
-            // 현재 프레임까지의 모든 상태 복사
-            if (!main_states.empty())
+            SoftwareRasterizer rasterizer;
+            FrameStateLog::Cursor states(state_log);
+            std::vector<cv::Mat> images = blank_images();
+            for (int frame = 1; frame <= frame_count; frame++)
             {
-                main_states[stacking_number + 1] = main_states[stacking_number];
+                render_one(rasterizer, states, images, frame);
+                encode(images, frame);
             }
-            if (!buffer_states.empty())
-            {
-                buffer_states[stacking_number + 1] = buffer_states[stacking_number];
+        }
+        else
+        {
+            threads = std::min<size_t>(threads, frame_count);
+            const int window = static_cast<int>(threads) * 2;
+            struct Slot {
+                std::vector<cv::Mat> images;    // 출력마다 한 장
+                int frame = 0;                  // 다 그려진 프레임 번호. 0 이면 비어 있음
+            };
+            std::vector<Slot> slots(window);
+            for (auto& slot : slots)
+            {
+                slot.images = blank_images();
+            }
+
+            std::mutex mutex;
+            std::condition_variable slot_changed;
+            int next_encode = 1;
+            std::atomic<int> next_frame{1};
+            // 처음 실패한 worker 나 인코더의 예외. 설정되면 모두 멈추고 worker 를 기다린 뒤 다시 던진다
+            std::exception_ptr failure;
+
+            ThreadPool pool(threads);
+            for (size_t worker = 0; worker < threads; worker++)
+            {
+                pool.submit([&] {
+                    try {
+                        SoftwareRasterizer rasterizer;
+                        FrameStateLog::Cursor states(state_log);
+                        for (int frame = next_frame++; frame <= frame_count; frame = next_frame++)
+                        {
+                            // 가장 앞선 미완성 프레임을 그리는 worker 는 기다리지 않으므로 교착되지 않는다
+                            {
+                                std::unique_lock<std::mutex> lock(mutex);
+                                slot_changed.wait(lock, [&] { return frame < next_encode + window || failure; });
+                                if (failure)
+                                    return;
+                            }
+                            Slot& slot = slots[frame % window];
+                            render_one(rasterizer, states, slot.images, frame);
+                            {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                slot.frame = frame;
+                            }
+                            slot_changed.notify_all();
+                        }
+                    } catch (...) {
+                        // 이 worker 의 프레임은 영영 채워지지 않으므로 인코더와 다른 worker 를 깨워 멈추게 한다
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            if (!failure)
+                                failure = std::current_exception();
+                        }
+                        slot_changed.notify_all();
+                    }
+                });
             }
 
-            if (pallet_id == 1) 
+            for (int frame = 1; frame <= frame_count; frame++)
             {
-                // 메인 팔렛트에 배치
-                if (main_states.find(stacking_number + 1) == main_states.end())
+                Slot& slot = slots[frame % window];
                 {
-                    main_states[stacking_number + 1] = {};
+                    std::unique_lock<std::mutex> lock(mutex);
+                    slot_changed.wait(lock, [&] { return slot.frame == frame || failure; });
+                    if (failure)
+                        break;
                 }
-                main_states[stacking_number + 1].push_back(placement_tuple);
-                total_volume += width * length * height;
-
-                // 버퍼에서 이동한 경우, 버퍼에서 제거
-                if (!buffer_states.empty())
-                {
-                    auto& last_buffer_state = buffer_states[stacking_number];
-                    auto it = std::find_if(last_buffer_state.begin(), last_buffer_state.end(),
-                        [&](const auto& state) {
-                            const auto& corners = std::get<0>(state);
-                            return std::abs(corners[0][0] - rotated_corners[0][0]) < 1e-6 &&
-                                   std::abs(corners[0][1] - rotated_corners[0][1]) < 1e-6;
-                        });
-                    if (it != last_buffer_state.end())
+                try {
+                    encode(slot.images, frame);
+                } catch (...) {
+                    // 인코더가 멈추면 창이 비지 않아 worker 들이 영영 기다리므로 같은 방식으로 멈추게 한다
                     {
-                        last_buffer_state.erase(it);
-                        if (buffer_states.find(stacking_number + 1) != buffer_states.end())
-                        {
-                            buffer_states[stacking_number + 1] = last_buffer_state;
-                        }
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!failure)
+                            failure = std::current_exception();
                     }
+                    slot_changed.notify_all();
+                    break;
                 }
-                double stacking_rate = (total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2])) * 100;
-                stacking_rates.push_back(stacking_rate);
-            }
-            else if (pallet_id == 2)
-            {
-                // 버퍼 팔렛트에 배치
-                if (buffer_states.find(stacking_number + 1) == buffer_states.end())
                 {
-                    buffer_states[stacking_number + 1] = {};
+                    std::lock_guard<std::mutex> lock(mutex);
+                    slot.frame = 0;
+                    next_encode = frame + 1;
                 }
-                buffer_states[stacking_number + 1].push_back(placement_tuple);
-            }
-
-            stacking_number++;
-            if (!is_valid)
-                break;
-        }
-
-        // 프레임 생성
-        for (int frame = 1; frame <= stacking_number; frame++)
-        {
-            std::string frame_filename;
-
-            if (frame < 10)
-            {
-                frame_filename = (result_path / ("frame_0" + std::to_string(frame) + ".png")).string();
-            }
-            else
-            {
-                frame_filename = (result_path / ("frame_" + std::to_string(frame) + ".png")).string();
+                slot_changed.notify_all();
             }
-            
-            // Set output for this frame
-            gp << "set output '" << frame_filename << "'\n";
-            
-            // Setup multiplot
-            gp << "set multiplot layout 2,2 spacing 0.1\n";
-
-            // Current states
-            const auto& current_main = main_states[frame];
-
-            // Generate all views
-            generate_view_800(gp, current_main, cubic_range, "Stacking with Buffer: Main Pallet x, z", 90, 0, 0.0, 0);
-            generate_view_800(gp, current_main, cubic_range, "Stacking with Buffer: Main Pallet x, y", 0, 90, 0.5, 0);
-
-            gp << "unset multiplot\n";
-            gp.flush();
-
-            // Wait for frame to be created
-            if (wait_for_frame(frame_filename))
+            pool.wait_idle();
+            if (failure)
             {
-                frame_filenames.push_back(frame_filename);
-                std::cout << "Created frame " << frame << "/" << stacking_number << std::endl;
+                std::rethrow_exception(failure);
             }
         }
 
-        // Create GIF if we have frames
-        if (!frame_filenames.empty())
-        {
-            std::string gif_filename = (result_path / (result_file_name + ".gif")).string();
-            std::cout << "\nCreating GIF: " << gif_filename << std::endl;
-            VisualizationUtils::create_gif(frame_filenames, gif_filename);
-            std::cout << "GIF creation completed" << std::endl;
-        }
-        else
+        for (size_t i = 0; i < outputs.size(); i++)
         {
-            std::cerr << "No frames were generated for GIF creation" << std::endl;
+            writers[i].close();
+            encoded[i] = writers[i].frame_count();
         }
-
-        return {total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2]) * 100, stacking_number};
+        return encoded;
     }
 
-private:
-    static void process_box_movement(
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>>& main_states,
-        std::map<int, std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>>& buffer_states,
-        int& current_frame,
-        const std::tuple<std::vector<std::vector<double>>, double, double>& placement_tuple,
-        double& total_volume,
-        const std::vector<double>& cubic_range,
-        std::vector<double>& stacking_rates,
-        const double box_volume,
-        bool is_buffer_to_main
-    )
+    // gnuplot 의 set origin / set size (왼쪽 아래 기준 비율) 를 프레임 픽셀 영역으로
+    static cv::Rect panel_rect(const cv::Mat& frame, double origin_x, double origin_y, double size_x, double size_y)
     {
-        if (is_buffer_to_main)
-        {
-            // Frame 1: Box still in buffer, not yet in main
-            if (main_states.find(current_frame) == main_states.end())
-            {
-                main_states[current_frame] = main_states[current_frame - 1];
-            }
-            if (buffer_states.find(current_frame) == buffer_states.end())
-            {
-                buffer_states[current_frame] = buffer_states[current_frame - 1];
-            }
-
-            // Frame 2: Box moved to main, removed from buffer
-            current_frame++;
-            main_states[current_frame] = main_states[current_frame - 1];
-            main_states[current_frame].push_back(placement_tuple);
-            
-            buffer_states[current_frame] = buffer_states[current_frame - 1];
-            auto& current_buffer_state = buffer_states[current_frame];
-            auto it = std::find_if(current_buffer_state.begin(), current_buffer_state.end(),
-                [&](const auto& state) {
-                    const auto& corners = std::get<0>(state);
-                    const double& state_z = std::get<1>(state);
-                    const double& state_height = std::get<2>(state);
-                    const auto& new_corners = std::get<0>(placement_tuple);
-                    
-                    bool corners_match = true;
-                    for (size_t i = 0; i < corners.size(); ++i) {
-                        if (std::abs(corners[i][0] - new_corners[i][0]) > 1e-6 ||
-                            std::abs(corners[i][1] - new_corners[i][1]) > 1e-6) {
-                            corners_match = false;
-                            break;
-                        }
-                    }
-                    return corners_match && 
-                           std::abs(state_z - std::get<1>(placement_tuple)) < 1e-6 && 
-                           std::abs(state_height - std::get<2>(placement_tuple)) < 1e-6;
-                });
-            
-            if (it != current_buffer_state.end())
-            {
-                current_buffer_state.erase(it);
-            }
-
-            total_volume += box_volume;
-            double stacking_rate = (total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2])) * 100;
-            stacking_rates.push_back(stacking_rate);
-            
-            std::cout << "Created transition frames for box movement from buffer to main" << std::endl;
-        }
-        else
-        {
-            if (main_states.find(current_frame) == main_states.end())
-            {
-                if (current_frame > 0)
-                {
-                    main_states[current_frame] = main_states[current_frame - 1];
-                }
-                else
-                {
-                    main_states[current_frame] = {};
-                }
-            }
-            main_states[current_frame].push_back(placement_tuple);
-            total_volume += box_volume;
-            
-            double stacking_rate = (total_volume / (cubic_range[0] * cubic_range[1] * cubic_range[2])) * 100;
-            stacking_rates.push_back(stacking_rate);
-        }
+        int x = static_cast<int>(std::lround(origin_x * frame.cols));
+        int y = static_cast<int>(std::lround((1.0 - origin_y - size_y) * frame.rows));
+        int width = static_cast<int>(std::lround(size_x * frame.cols));
+        int height = static_cast<int>(std::lround(size_y * frame.rows));
+        return cv::Rect(x, y, width, height);
     }
-    
-    static void generate_view_800(Gnuplot& gp, 
-                            const std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>& placements,
-                            const std::vector<double>& cubic_range,
-                            const std::string& title,
-                            int view1,
-                            int view2,
-                            double origin_x,
-                            double origin_y) 
+
+    static void draw_panel(SoftwareRasterizer& rasterizer,
+                           cv::Mat& frame,
+                           const ViewPanel& panel,
+                           const FrameStateLog::Cursor::PalletView& placements,
+                           const std::vector<double>& cubic_range)
     {
-        gp << "reset\n";
-        gp << "set size 0.5,1\n";
-        gp << "set origin " << origin_x << "," << origin_y << "\n";
-        gp << "set title '" << title << "'\n";
-        gp << "set view " << view1 << "," << view2 << "\n";
-        gp << "set xrange [0:" << cubic_range[0] << "]\n";
-        gp << "set yrange [0:" << cubic_range[1] << "]\n";
-        gp << "set zrange [0:" << cubic_range[2] << "]\n";
-        gp << "set ticslevel 0\n";
-        gp << "set grid\n";
-        
-        for (const auto& placement : placements)
-        {
-            std::string color = (title.find("Buffer Pallet") != std::string::npos) ? "0xFFCCCC" : "0xFFFFCC";
-            VisualizationUtils::plot_3d_box(gp, std::get<0>(placement), std::get<1>(placement), 
-                                          std::get<2>(placement), color, 0.5f);
-        }
-        gp << "splot NaN notitle\n";
+        uint32_t color = (panel.pallet_id == FrameStateLog::BUFFER_PALLET) ? 0xFFCCCC : 0xFFFFCC;
+        rasterizer.draw_view(frame, panel_rect(frame, panel.origin_x, panel.origin_y, panel.size_x, panel.size_y),
+                             placements, cubic_range, panel.view1, panel.view2,
+                             SoftwareRasterizer::rgb_color(color), panel.title, 0.5);
     }
 
-    static void generate_view_1600(Gnuplot& gp, 
-                            const std::vector<std::tuple<std::vector<std::vector<double>>, double, double>>& placements,
-                            const std::vector<double>& cubic_range,
-                            const std::string& title,
-                            int view1,
-                            int view2,
-                            double origin_x,
-                            double origin_y) 
+    static void write_rate_graph(const std::string& graph_file, const std::vector<double>& stacking_rates, int frame_count)
     {
-        gp << "reset\n";
-        gp << "set size 0.5,0.5\n";
-        gp << "set origin " << origin_x << "," << origin_y << "\n";
-        gp << "set title '" << title << "'\n";
-        gp << "set view " << view1 << "," << view2 << "\n";
-        gp << "set xrange [0:" << cubic_range[0] << "]\n";
-        gp << "set yrange [0:" << cubic_range[1] << "]\n";
-        gp << "set zrange [0:" << cubic_range[2] << "]\n";
-        gp << "set ticslevel 0\n";
+        Gnuplot gp;
+        gp << "set terminal pngcairo size 800, 800 enhanced font 'Verdana, 12'\n";
+        gp << "set output '" << graph_file << "'\n";
+        gp << "set title 'Stacking Rate Over Frames'\n";
+        gp << "set xlabel 'Frame'\n";
+        gp << "set xrange [0:" << frame_count << "]\n";
+        gp << "set ylabel 'Stacking Rate (%)'\n";
+        gp << "set yrange [0:100]\n";
         gp << "set grid\n";
-        
-        for (const auto& placement : placements)
+        gp << "plot '-' with linespoints title 'Stacking Rate (%)' lc rgb 'blue'\n";
+
+        for (size_t i = 0; i < stacking_rates.size(); ++i)
         {
-            std::string color = (title.find("Buffer Pallet") != std::string::npos) ? "0xFFCCCC" : "0xFFFFCC";
-            VisualizationUtils::plot_3d_box(gp, std::get<0>(placement), std::get<1>(placement), 
-                                          std::get<2>(placement), color, 0.5f);
+            gp << i + 1 << " " << stacking_rates[i] << "\n";
         }
-        gp << "splot NaN notitle\n";
+        gp << "e\n";
+        gp.flush();
+
+        std::cout << "Stacking rate graph saved to: " << graph_file << std::endl;
     }
 
-    static bool wait_for_frame(const std::string& frame_filename)
+    static bool write_frame(const std::string& frame_filename, const cv::Mat& frame)
     {
-        int retry_count = 0;
-        const int max_retries = 20;
-        const int wait_time = 100;
-        
-        while (retry_count < max_retries)
+        bool written = false;
+        try {
+            written = cv::imwrite(frame_filename, frame);
+        } catch (const cv::Exception& e) {
+            std::cerr << "Error writing frame: " << e.what() << std::endl;
+        }
+        if (!written)
         {
-            std::error_code ec;
-            if (std::filesystem::exists(frame_filename))
-            {
-                uintmax_t size = std::filesystem::file_size(frame_filename, ec);
-                if (!ec && size > 0)
-                {
-                    #ifdef _WIN32
-                        Sleep(wait_time);
-                    #else
-                        usleep(wait_time * 1000);
-                    #endif
-                    return true;
-                }
-            }
-            retry_count++;
-            #ifdef _WIN32
-                Sleep(wait_time);
-            #else
-                usleep(wait_time * 1000);
-            #endif
+            std::cerr << "Failed to create frame: " << frame_filename << std::endl;
         }
-        
-        std::cerr << "Failed to create frame: " << frame_filename << std::endl;
-        return false;
+        return written;
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -17,26 +17,39 @@
 #include <random>
 #include <exception>
 #include <memory>
-
-#include <opencv2/opencv.hpp>
-#include <nlohmann/json.hpp>
-#include <gnuplot-iostream.h>
-#include <gif_lib.h>
-#include <Eigen/Dense>
-
-#include "jsonUtils.hpp"
-#include "boxGenerator.hpp"
-#include "geometryUtils.hpp"
-#include "visualizationUtils.hpp"
+#include <memory_resource>
+#include <array>
+#include <cstddef>
+
+#include "planCache.hpp"
+#include "cowVector.hpp"
+#include "stackingBounds.hpp"
+#include "rectPacker.hpp"
+#include "geometryTypes.hpp"
+#include "boxRecord.hpp"
+#include "stackResult.hpp"
 
 enum class StackingMethod {
     PALLET_ORIGIN_OUT_OF_BOUND,
     PALLET_STACK_ALL,
     BUFFER,
     STACK_WITH_BUFFER,
-    OPTIMIZED_STACK
+    OPTIMIZED_STACK,
+    LAYERED
 };
 
+// 명령행 이름 -> 방식. batch_main 과 planner_client 가 함께 쓴다
+inline bool parse_stacking_method(const std::string& name, StackingMethod& method)
+{
+    if (name == "layered") method = StackingMethod::LAYERED;
+    else if (name == "optimized") method = StackingMethod::OPTIMIZED_STACK;
+    else if (name == "stack_all") method = StackingMethod::PALLET_STACK_ALL;
+    else if (name == "buffer") method = StackingMethod::BUFFER;
+    else if (name == "stack_with_buffer") method = StackingMethod::STACK_WITH_BUFFER;
+    else return false;
+    return true;
+}
+
 std::vector<int> parseBoxSize(const std::string& sizeStr)
 {
     std::vector<int> sizes;
@@ -60,54 +73,81 @@ std::vector<int> parseBoxSize(const std::string& sizeStr)
 class BoxPlacement {
 private:
     std::vector<int> pallet_dimensions;
-    std::vector<bool> grid_cells;
+    CowBitGrid grid_cells;
     const int grid_size;
     
     struct PlacedBox {
-        std::tuple<int, int, int> position;
-        std::vector<int> size;
+        AABB bounds;
         int rotation;
     };
-    std::vector<PlacedBox> placed_boxes;
+    CowVector<PlacedBox> placed_boxes;
+
+    // 트랜잭션 undo 기록: 변경 전 word 값과 트랜잭션 시작 시점
+    struct JournalEntry {
+        size_t word_index;
+        uint64_t old_word;
+    };
+    struct Savepoint {
+        size_t journal_size;
+        size_t placed_count;
+    };
+    std::vector<JournalEntry> journal;
+    std::vector<Savepoint> savepoints;
+
+    void setCell(size_t idx, bool value)
+    {
+        if (!savepoints.empty())
+        {
+            size_t word_index = CowBitGrid::word_index(idx);
+            // 같은 word 를 연속으로 건드리는 경우(x 방향 순회)는 한 번만 기록한다
+            if (journal.size() == savepoints.back().journal_size || journal.back().word_index != word_index)
+            {
+                journal.push_back({word_index, grid_cells.word(word_index)});
+            }
+        }
+        grid_cells.set(idx, value);
+    }
 
-    std::vector<int> getRotatedSize(const std::vector<int>& original_size, int rotation)
+    static AABB getRotatedBounds(const std::vector<int>& original_size,
+                                 const std::tuple<int, int, int>& position,
+                                 int rotation)
     {
-        std::vector<int> new_size = original_size;
+        AABB bounds{{std::get<0>(position), std::get<1>(position), std::get<2>(position)},
+                    {original_size[0], original_size[1], original_size[2]}};
         if (rotation == 90)
         {
-            std::swap(new_size[0], new_size[1]);
+            std::swap(bounds.size.x, bounds.size.y);
         }
-        return new_size;
+        return bounds;
     }
 
-    bool isWithinBounds(const std::tuple<int, int, int>& pos, 
-                       const std::vector<int>& size) {
-        int x = std::get<0>(pos);
-        int y = std::get<1>(pos);
-        int z = std::get<2>(pos);
+    bool isWithinBounds(const AABB& box) {
+        const Vec3i& pos = box.origin;
+        const Vec3i& size = box.size;
 
-        return (x >= 0 && x + size[0] <= pallet_dimensions[0] &&
-                y >= 0 && y + size[1] <= pallet_dimensions[1] &&
-                z >= 0 && z + size[2] <= pallet_dimensions[2]);
+        return (pos.x >= 0 && pos.x + size.x <= pallet_dimensions[0] &&
+                pos.y >= 0 && pos.y + size.y <= pallet_dimensions[1] &&
+                pos.z >= 0 && pos.z + size.z <= pallet_dimensions[2]);
     }
 
-    bool hasOverlap(const std::tuple<int, int, int>& pos, const std::vector<int>& size)
+    bool hasOverlap(const AABB& box)
     {
-        int x1 = std::get<0>(pos);
-        int y1 = std::get<1>(pos);
-        int z1 = std::get<2>(pos);
+        int x1 = box.origin.x;
+        int y1 = box.origin.y;
+        int z1 = box.origin.z;
+        const Vec3i& size = box.size;
 
-        for (int z = z1/grid_size; z <= (z1 + size[2])/grid_size; z++)
+        for (int z = z1/grid_size; z <= (z1 + size.z)/grid_size; z++)
         {
-            for (int y = y1/grid_size; y <= (y1 + size[1])/grid_size; y++)
+            for (int y = y1/grid_size; y <= (y1 + size.y)/grid_size; y++)
             {
-                for (int x = x1/grid_size; x <= (x1 + size[0])/grid_size; x++)
+                for (int x = x1/grid_size; x <= (x1 + size.x)/grid_size; x++)
                 {
                     int idx = (z * (pallet_dimensions[0]/grid_size) * 
                               (pallet_dimensions[1]/grid_size)) +
                              (y * (pallet_dimensions[0]/grid_size)) + x;
                     
-                    if (grid_cells[idx])
+                    if (grid_cells.test(idx))
                     {
                         return true;
                     }
@@ -117,22 +157,23 @@ private:
         return false;
     }
 
-    void markGridCells(const std::tuple<int, int, int>& pos, const std::vector<int>& size, bool value)
+    void markGridCells(const AABB& box, bool value)
     {
-        int x1 = std::get<0>(pos);
-        int y1 = std::get<1>(pos);
-        int z1 = std::get<2>(pos);
+        int x1 = box.origin.x;
+        int y1 = box.origin.y;
+        int z1 = box.origin.z;
+        const Vec3i& size = box.size;
 
-        for (int z = z1/grid_size; z <= (z1 + size[2])/grid_size; z++)
+        for (int z = z1/grid_size; z <= (z1 + size.z)/grid_size; z++)
         {
-            for (int y = y1/grid_size; y <= (y1 + size[1])/grid_size; y++)
+            for (int y = y1/grid_size; y <= (y1 + size.y)/grid_size; y++)
             {
-                for (int x = x1/grid_size; x <= (x1 + size[0])/grid_size; x++)
+                for (int x = x1/grid_size; x <= (x1 + size.x)/grid_size; x++)
                 {
                     int idx = (z * (pallet_dimensions[0]/grid_size) * 
                               (pallet_dimensions[1]/grid_size)) +
                              (y * (pallet_dimensions[0]/grid_size)) + x;
-                    grid_cells[idx] = value;
+                    setCell(idx, value);
                 }
             }
         }
@@ -141,56 +182,141 @@ private:
 public:
     BoxPlacement(const std::vector<int>& pallet_dims) 
         : pallet_dimensions(pallet_dims), grid_size(5) {
-        grid_cells.resize((pallet_dims[0]/grid_size) * 
-                         (pallet_dims[1]/grid_size) * 
-                         (pallet_dims[2]/grid_size), false);
+        int nx = pallet_dims[0]/grid_size;
+        int ny = pallet_dims[1]/grid_size;
+        int nz = pallet_dims[2]/grid_size;
+        // 셀 범위가 상한을 포함(<=)하므로 마지막 행/층 다음 셀까지 여유를 둔다
+        grid_cells = CowBitGrid(static_cast<size_t>(nx) * ny * (nz + 1) + static_cast<size_t>(nx) * (ny + 1) + nx + 1);
     }
 
+    // 격자와 배치 목록은 copy-on-write 로 공유되므로 복사(fork)는 O(1) 이다
+    BoxPlacement(const BoxPlacement&) = default;
+
     bool canPlaceBox(const std::vector<int>& box_size, 
                      const std::tuple<int, int, int>& position,
                      int rotation) {
-        auto rotated_size = getRotatedSize(box_size, rotation);
+        AABB bounds = getRotatedBounds(box_size, position, rotation);
         
-        if (!isWithinBounds(position, rotated_size))
+        if (!isWithinBounds(bounds))
         {
             return false;
         }
 
-        return !hasOverlap(position, rotated_size);
+        return !hasOverlap(bounds);
     }
 
     void placeBox(const std::vector<int>& box_size,
                   const std::tuple<int, int, int>& position,
                   int rotation) {
-        auto rotated_size = getRotatedSize(box_size, rotation);
-        markGridCells(position, rotated_size, true);
-        placed_boxes.push_back({position, rotated_size, rotation});
+        AABB bounds = getRotatedBounds(box_size, position, rotation);
+        markGridCells(bounds, true);
+        placed_boxes.push_back({bounds, rotation});
+    }
+
+    // begin/rollback/commit 은 중첩할 수 있다. rollback 은 트랜잭션 동안 바뀐 word 만
+    // 원래 값으로 되돌리므로 이웃 박스와 공유하는 셀도 그대로 유지된다
+    void beginTransaction()
+    {
+        savepoints.push_back({journal.size(), placed_boxes.size()});
+    }
+
+    void rollbackTransaction()
+    {
+        if (savepoints.empty())
+            return;
+
+        Savepoint savepoint = savepoints.back();
+        savepoints.pop_back();
+        while (journal.size() > savepoint.journal_size)
+        {
+            grid_cells.set_word(journal.back().word_index, journal.back().old_word);
+            journal.pop_back();
+        }
+        while (placed_boxes.size() > savepoint.placed_count)
+        {
+            placed_boxes.pop_back();
+        }
+    }
+
+    void commitTransaction()
+    {
+        if (savepoints.empty())
+            return;
+
+        savepoints.pop_back();
+        if (savepoints.empty())
+        {
+            journal.clear();
+        }
+    }
+
+    size_t placedCount() const
+    {
+        return placed_boxes.size();
     }
 };
 
 class StackingAlgorithm {
 private:
-    std::vector<std::unordered_map<std::string, std::string>> boxes;
+    std::vector<std::string> box_ids;                         // 입력 순서의 박스 id
     std::vector<int> pallet_size;
     int stacking_interval;
+    std::vector<std::vector<int>> parsed_sizes;               // 박스 인덱스별 치수, 추가 시 한 번만 파싱
+    std::unordered_map<std::string, size_t> box_index_of;     // box_id -> 박스 인덱스
+
+    // 실행(Stack 호출) 단위 임시 메모리. 실행이 시작될 때 한 번에 비운다
+    // 버퍼는 0 으로 채우지 않는다 (new std::byte[N] 은 초기화하지 않으므로 쓰기 전에는 페이지도 잡히지 않는다)
+    static constexpr size_t RUN_ARENA_BYTES = 256 * 1024;
+    std::unique_ptr<std::byte[]> arena_storage;
+    std::pmr::monotonic_buffer_resource run_arena;
     std::unique_ptr<BoxPlacement> placement_manager;
-
-    struct StackResult {
-        std::string box_id;
-        std::tuple<int, int, int> box_loc;
-        int box_rot;
-        int pallet_id;
-    };
-
-    std::vector<StackResult> final_placements;
-    std::vector<std::tuple<int, int, int, int, int, int>> main_placements;
-    std::vector<std::tuple<int, int, int, int, int, int>> buffer_placements;
-    std::set<std::string> used_boxes;
+    PlanCache* plan_cache = nullptr;
+    StackResultSink result_sink;
+    bool verbose = false;         // 진행 상황 (버퍼 -> 메인 이동, 소멸) 을 std::cout 에 출력
+
+    CowVector<StackResult> final_placements;
+    CowVector<std::tuple<int, int, int, int, int, int>> main_placements;
+    CowVector<std::tuple<int, int, int, int, int, int>> buffer_placements;
+    CowVector<char> used_boxes;   // 박스 인덱스 기준 사용 여부
+    // 아래 둘은 스냅샷과 통째로 공유하고, 수정할 때 unshared() 로 공유 중이면 먼저 복제한다
+    std::shared_ptr<PalletBounds> main_bounds;     // 메인 팔레트 조기 종료 판정
+    std::shared_ptr<MaxRectsPacker> buffer_packer; // 버퍼 팔레트는 z = 0 에만 놓이므로 2D 로 관리
     int buffer_count = 0;
+    bool setup_valid = true;      // valid_setup(pallet_size, stacking_interval)
     const int MAX_BUFFER_COUNT = 100;
+    const double LAYER_HEIGHT_TOLERANCE = 0.1;   // 층 높이 대비 허용하는 높이 차 비율
+
+    // 치수가 셋이 아니면 멤버 초기화에서 범위를 벗어나지 않도록 0 으로 채운다 (setup_valid 가 false 가 된다)
+    static std::vector<int> pallet_dims(const std::vector<int>& pallet_size)
+    {
+        return pallet_size.size() == 3 ? pallet_size : std::vector<int>{0, 0, 0};
+    }
+
+    // 스냅샷과 공유 중이면 복제한 뒤 수정할 수 있는 객체를 돌려준다 (copy-on-write)
+    template <typename T>
+    static T& unshared(std::shared_ptr<T>& state)
+    {
+        if (state.use_count() > 1)
+        {
+            state = std::make_shared<T>(*state);
+        }
+        return *state;
+    }
+
+    // 결과 목록에 추가하고, 결과 sink 가 있으면 바로 넘긴다
+    template <typename Results>
+    void record_result(Results& results, const StackResult& result)
+    {
+        results.push_back(result);
+        if (result_sink)
+        {
+            result_sink(result);
+        }
+    }
 
+    template <typename Placements>
     bool is_overlap(const std::tuple<int, int, int, int, int, int>& new_box,
-                    const std::vector<std::tuple<int, int, int, int, int, int>>& placements)
+                    const Placements& placements)
     {
         int bx, by, bz, bwidth, blength, bheight;
         std::tie(bx, by, bz, bwidth, blength, bheight) = new_box;
@@ -210,51 +336,56 @@ private:
         return false;
     }
 
-    bool try_place_in_buffer(const std::unordered_map<std::string, std::string>& box)
+    bool try_place_in_buffer(size_t box_index)
     {
-        std::vector<int> box_sizes = parseBoxSize(box.at("box_size"));
+        const std::string& box_id = box_ids[box_index];
+        const std::vector<int>& box_sizes = parsed_sizes[box_index];
         if (box_sizes.size() < 3)
         {
-            std::cerr << "Invalid box size for box ID: " << box.at("box_id") << std::endl;
+            std::cerr << "Invalid box size for box ID: " << box_id << std::endl;
             return false;
         }
 
-        for (int y = 0; y <= pallet_size[1] - box_sizes[1]; y += stacking_interval)
+        PackedRect rect;
+        if (!unshared(buffer_packer).insert(box_sizes[0] + stacking_interval, box_sizes[1] + stacking_interval, false, rect))
         {
-            for (int x = 0; x <= pallet_size[0] - box_sizes[0]; x += stacking_interval)
-            {
-                if (!is_overlap(std::make_tuple(x, y, 0, box_sizes[0], box_sizes[1], box_sizes[2]), buffer_placements))
-                {
-                    buffer_placements.push_back(std::make_tuple(
-                        x, y, 0,
-                        box_sizes[0] + stacking_interval,
-                        box_sizes[1] + stacking_interval,
-                        box_sizes[2] + stacking_interval
-                    ));
-
-                    final_placements.push_back({
-                        box.at("box_id"),
-                        std::make_tuple(x + std::ceil(box_sizes[0] / 2.0), 
-                                      y + std::ceil(box_sizes[1] / 2.0), 0),
-                        0,
-                        2
-                    });
-
-                    buffer_count++;
-                    used_boxes.insert(box.at("box_id"));
-                    return true;
-                }
-            }
+            return false;
         }
-        return false;
+
+        int x = rect.x;
+        int y = rect.y;
+        buffer_placements.push_back(std::make_tuple(
+            x, y, 0,
+            box_sizes[0] + stacking_interval,
+            box_sizes[1] + stacking_interval,
+            box_sizes[2] + stacking_interval
+        ));
+
+        record_result(final_placements, {
+            box_id,
+            std::make_tuple(x + std::ceil(box_sizes[0] / 2.0), 
+                          y + std::ceil(box_sizes[1] / 2.0), 0),
+            0,
+            2
+        });
+
+        buffer_count++;
+        used_boxes.set(box_index, 1);
+        return true;
     }
 
-    bool try_place_in_main(const std::unordered_map<std::string, std::string>& box)
+    bool try_place_in_main(size_t box_index)
     {
-        std::vector<int> box_sizes = parseBoxSize(box.at("box_size"));
+        const std::string& box_id = box_ids[box_index];
+        const std::vector<int>& box_sizes = parsed_sizes[box_index];
         if (box_sizes.size() < 3)
         {
-            std::cerr << "Invalid box size for box ID: " << box.at("box_id") << std::endl;
+            std::cerr << "Invalid box size for box ID: " << box_id << std::endl;
+            return false;
+        }
+
+        if (main_bounds->is_hopeless(box_sizes))
+        {
             return false;
         }
 
@@ -266,6 +397,7 @@ private:
                 {
                     if (!is_overlap(std::make_tuple(x, y, z, box_sizes[0], box_sizes[1], box_sizes[2]), main_placements))
                     {
+                        unshared(main_bounds).add_placed(box_sizes);
                         main_placements.push_back(std::make_tuple(
                             x, y, z,
                             box_sizes[0] + stacking_interval,
@@ -273,26 +405,27 @@ private:
                             box_sizes[2] + stacking_interval
                         ));
 
-                        final_placements.push_back({
-                            box.at("box_id"),
+                        record_result(final_placements, {
+                            box_id,
                             std::make_tuple(x + std::ceil(box_sizes[0] / 2.0), 
                                           y + std::ceil(box_sizes[1] / 2.0), z),
                             0,
                             1
                         });
 
-                        used_boxes.insert(box.at("box_id"));
+                        used_boxes.set(box_index, 1);
                         return true;
                     }
                 }
             }
         }
+        unshared(main_bounds).add_failed(box_sizes);
         return false;
     }
 
     bool tryPlaceBox(const std::vector<int>& box_size, std::tuple<int, int, int>& position, int& rotation)
     {
-        std::vector<int> rotations = {0, 90};  // 가능한 회전 각도들
+        static constexpr int rotations[] = {0, 90};  // 가능한 회전 각도들
         
         for (int z = 0; z <= pallet_size[2] - box_size[2]; z += stacking_interval)
         {
@@ -318,22 +451,176 @@ private:
     }
 
     public:
+    // 같은 입력에 대한 배치 결과가 바뀌는 변경 (탐색 순서, 가지치기, packer 등) 마다 올린다.
+    // 계획 캐시 파일에 기록되어, 다른 revision 에서 만든 캐시는 쓰지 않는다
+    static constexpr uint32_t PLANNER_REVISION = 1;
+
     StackingAlgorithm(const std::vector<std::unordered_map<std::string, std::string>>& boxes, const std::vector<int>& pallet_size, int box_gap = 5)
-        : boxes(boxes), pallet_size(pallet_size), stacking_interval(box_gap)
-    {}
+        : StackingAlgorithm(pallet_size, box_gap)
+    {
+        reserve_boxes(boxes.size());
+        for (const auto& box : boxes)
+        {
+            add_box(box.at("box_id"), parseBoxSize(box.at("box_size")));
+        }
+    }
+
+    StackingAlgorithm(const std::vector<BoxRecord>& records, const std::vector<int>& pallet_size, int box_gap = 5)
+        : StackingAlgorithm(pallet_size, box_gap)
+    {
+        reserve_boxes(records.size());
+        for (const auto& record : records)
+        {
+            add_box(record);
+        }
+    }
+
+    // 박스 없이 만든 뒤 로더 콜백에서 add_box 로 채울 수 있다
+    // 팔레트 치수나 간격이 잘못되면 Stack 은 빈 결과를 반환한다
+    StackingAlgorithm(const std::vector<int>& pallet_size, int box_gap = 5)
+        : pallet_size(pallet_dims(pallet_size)), stacking_interval(box_gap),
+          arena_storage(new std::byte[RUN_ARENA_BYTES]), run_arena(arena_storage.get(), RUN_ARENA_BYTES),
+          main_bounds(std::make_shared<PalletBounds>(this->pallet_size, false)),
+          buffer_packer(std::make_shared<MaxRectsPacker>(this->pallet_size[0] + box_gap, this->pallet_size[1] + box_gap, box_gap))
+    {
+        setup_valid = valid_setup(pallet_size, box_gap);
+    }
+
+    // 탐색 루프는 간격만큼 전진하므로 간격이 0 이하이면 끝나지 않는다
+    static bool valid_setup(const std::vector<int>& pallet_size, int box_gap)
+    {
+        if (pallet_size.size() != 3 || box_gap <= 0)
+            return false;
+        for (int dim : pallet_size)
+        {
+            if (dim <= 0)
+                return false;
+        }
+        return true;
+    }
+
+    void reserve_boxes(size_t count)
+    {
+        box_ids.reserve(count);
+        parsed_sizes.reserve(count);
+        box_index_of.reserve(count);
+    }
+
+    void add_box(const BoxRecord& record)
+    {
+        add_box(std::to_string(record.box_id), {record.box_size[0], record.box_size[1], record.box_size[2]});
+    }
+
+    void add_box(const std::string& box_id, std::vector<int> box_size)
+    {
+        box_index_of[box_id] = box_ids.size();
+        box_ids.push_back(box_id);
+        parsed_sizes.push_back(std::move(box_size));
+        used_boxes.push_back(0);
+    }
+
+    // 박스와 실행 상태를 모두 비우고 새 주문을 받을 준비를 한다.
+    // 할당된 용량과 arena 는 그대로 남으므로 상주 프로세스가 인스턴스를 재사용할 수 있다
+    void reset_order(const std::vector<int>& new_pallet_size, int box_gap)
+    {
+        setup_valid = valid_setup(new_pallet_size, box_gap);
+        pallet_size = pallet_dims(new_pallet_size);
+        stacking_interval = box_gap;
+        box_ids.clear();
+        parsed_sizes.clear();
+        box_index_of.clear();
+
+        final_placements.clear();
+        main_placements.clear();
+        buffer_placements.clear();
+        used_boxes.clear();
+        main_bounds = std::make_shared<PalletBounds>(pallet_size, false);
+        buffer_packer = std::make_shared<MaxRectsPacker>(pallet_size[0] + box_gap, pallet_size[1] + box_gap, box_gap);
+        buffer_count = 0;
+        placement_manager.reset();
+        run_arena.release();
+    }
+
+    // 팔레트 상태 스냅샷. 배치 기록은 CowVector 로, 조기 종료 판정과 버퍼 packer 는 객체째 공유하므로
+    // 생성은 O(1) 이다. 이후 수정된 chunk 와, 처음 수정되는 판정/packer 객체만 복제된다.
+    // BoxPlacement 는 복사하지만 점유 격자와 배치 목록이 copy-on-write 라 치수 몇 개만 실제로 복사된다
+    struct Snapshot {
+        CowVector<StackResult> final_placements;
+        CowVector<std::tuple<int, int, int, int, int, int>> main_placements;
+        CowVector<std::tuple<int, int, int, int, int, int>> buffer_placements;
+        CowVector<char> used_boxes;
+        std::shared_ptr<const PalletBounds> main_bounds;
+        std::shared_ptr<const MaxRectsPacker> buffer_packer;
+        int buffer_count;
+        std::shared_ptr<const BoxPlacement> placement_manager;
+    };
+
+    Snapshot snapshot() const
+    {
+        return {
+            final_placements,
+            main_placements,
+            buffer_placements,
+            used_boxes,
+            main_bounds,
+            buffer_packer,
+            buffer_count,
+            placement_manager ? std::make_shared<const BoxPlacement>(*placement_manager) : nullptr
+        };
+    }
+
+    void restore(const Snapshot& state)
+    {
+        final_placements = state.final_placements;
+        main_placements = state.main_placements;
+        buffer_placements = state.buffer_placements;
+        used_boxes = state.used_boxes;
+        // 스냅샷이 살아 있는 동안은 unshared() 가 수정 전에 복제하므로 스냅샷 쪽 객체는 바뀌지 않는다
+        main_bounds = std::const_pointer_cast<PalletBounds>(state.main_bounds);
+        buffer_packer = std::const_pointer_cast<MaxRectsPacker>(state.buffer_packer);
+        buffer_count = state.buffer_count;
+        placement_manager = state.placement_manager ? std::make_unique<BoxPlacement>(*state.placement_manager) : nullptr;
+    }
 
     ~StackingAlgorithm()
     {
-        std::cout << "Object Destroyed" << std::endl;
+        if (verbose)
+        {
+            std::cout << "Object Destroyed" << std::endl;
+        }
+    }
+
+    // 배치 워커 여러 개가 동시에 돌면 출력이 뒤섞이므로 기본은 끈다
+    void set_verbose(bool enabled)
+    {
+        verbose = enabled;
+    }
+
+    // 같은 주문 서명의 계획이 캐시에 있으면 Stack 은 탐색 없이 캐시된 배치를 반환한다.
+    // 결과 sink 가 있으면 캐시를 조회하지 않고 탐색한다 (계산한 계획은 그대로 저장한다)
+    void set_plan_cache(PlanCache* cache)
+    {
+        plan_cache = cache;
+    }
+
+    // 배치가 결정되는 즉시 결과를 넘겨받는다. 캐시에는 최종 배치만 남아 버퍼 배치와 버퍼 -> 메인 이동이 빠지므로,
+    // sink 가 있는 동안은 캐시 적중을 쓰지 않고 매번 탐색해서 같은 입력이면 항상 같은 기록이 전달된다.
+    // snapshot/restore 로 되돌린 배치는 이미 전달된 뒤이므로 취소되지 않는다
+    void set_result_sink(StackResultSink sink)
+    {
+        result_sink = std::move(sink);
     }
 
     std::vector<StackResult> stack_pallet_origin_out_of_bound()
     {
         std::vector<StackResult> result;
+        if (box_ids.empty())
+        {
+            return result;
+        }
         int pallet_id = 1;
-        const auto& box = boxes[0];
-        result.push_back({
-            box.at("box_id"),
+        record_result(result, {
+            box_ids[0],
             std::make_tuple(0, 0, 0),
             0,
             pallet_id 
@@ -352,33 +639,41 @@ private:
         {
             if (placement.pallet_id == 2)
             {
-                auto box_it = std::find_if(boxes.begin(), boxes.end(),
-                    [&](const auto& b) { return b.at("box_id") == placement.box_id; });
-                if (box_it != boxes.end())
+                auto index_it = box_index_of.find(placement.box_id);
+                if (index_it != box_index_of.end())
                 {
-                    auto curr_sizes = parseBoxSize(box_it->at("box_size"));
-                    
-                    for (int z = 0; z <= pallet_size[2] - curr_sizes[2]; z += stacking_interval)
+                    const auto& curr_sizes = parsed_sizes[index_it->second];
+
+                    // 적합도 점수 계산 (여기서는 간단히 부피로 계산)
+                    // 점수가 위치와 무관하므로 더 높은 점수를 낼 수 없거나 놓일 수 없는 박스는 탐색하지 않는다
+                    int fit_score = curr_sizes[0] * curr_sizes[1] * curr_sizes[2];
+                    if (fit_score <= best_fit_score || main_bounds->is_hopeless(curr_sizes))
+                        continue;
+
+                    bool found = false;
+                    for (int z = 0; z <= pallet_size[2] - curr_sizes[2] && !found; z += stacking_interval)
                     {
-                        for (int y = 0; y <= pallet_size[1] - curr_sizes[1]; y += stacking_interval)
+                        for (int y = 0; y <= pallet_size[1] - curr_sizes[1] && !found; y += stacking_interval)
                         {
                             for (int x = 0; x <= pallet_size[0] - curr_sizes[0]; x += stacking_interval)
                             {
                                 if (!is_overlap(std::make_tuple(x, y, z, curr_sizes[0], curr_sizes[1], curr_sizes[2]), main_placements))
                                 {
-                                    // 적합도 점수 계산 (여기서는 간단히 부피로 계산)
-                                    int fit_score = curr_sizes[0] * curr_sizes[1] * curr_sizes[2];
-                                    if (fit_score > best_fit_score)
-                                    {
-                                        best_fit_score = fit_score;
-                                        best_box_id = placement.box_id;
-                                        best_box_size = curr_sizes;
-                                        best_location = std::make_tuple(x, y, z);
-                                    }
+                                    best_fit_score = fit_score;
+                                    best_box_id = placement.box_id;
+                                    best_box_size = curr_sizes;
+                                    best_location = std::make_tuple(x, y, z);
+                                    found = true;
+                                    break;
                                 }
                             }
                         }
                     }
+
+                    if (!found)
+                    {
+                        unshared(main_bounds).add_failed(curr_sizes);
+                    }
                 }
             }
         }
@@ -399,37 +694,32 @@ private:
 
             if (it != final_placements.end())
             {
+                // 버퍼 팔레트 업데이트: 옮긴 박스 자리만 빈 공간으로 되돌린다
+                int buffer_x = std::get<0>(it->box_loc) - static_cast<int>(std::ceil(best_box_size[0] / 2.0));
+                int buffer_y = std::get<1>(it->box_loc) - static_cast<int>(std::ceil(best_box_size[1] / 2.0));
+                unshared(buffer_packer).remove({
+                    buffer_x, buffer_y,
+                    best_box_size[0] + stacking_interval,
+                    best_box_size[1] + stacking_interval,
+                    false
+                });
+                auto buffer_it = std::find_if(buffer_placements.begin(), buffer_placements.end(),
+                    [&](const auto& p) { return std::get<0>(p) == buffer_x && std::get<1>(p) == buffer_y; });
+                if (buffer_it != buffer_placements.end())
+                {
+                    buffer_placements.erase(buffer_it);
+                }
+
                 final_placements.erase(it);
                 buffer_count--;
-                std::cout << "Moved box " << best_box_id << " from buffer to main" << std::endl;
-
-                // 버퍼 팔레트 업데이트
-                buffer_placements.clear();
-                for (const auto& p : final_placements)
+                if (verbose)
                 {
-                    if (p.pallet_id == 2)
-                    {
-                        auto box_info = std::find_if(boxes.begin(), boxes.end(),
-                            [&](const auto& b) { return b.at("box_id") == p.box_id; });
-
-                        if (box_info != boxes.end())
-                        {
-                            auto sizes = parseBoxSize(box_info->at("box_size"));
-                            auto [x, y, z] = p.box_loc;
-                            buffer_placements.push_back(std::make_tuple(
-                                x - std::ceil(sizes[0] / 2.0),
-                                y - std::ceil(sizes[1] / 2.0),
-                                z,
-                                sizes[0] + stacking_interval,
-                                sizes[1] + stacking_interval,
-                                sizes[2] + stacking_interval
-                            ));
-                        }
-                    }
+                    std::cout << "Moved box " << best_box_id << " from buffer to main" << std::endl;
                 }
 
                 // 메인 팔레트에 박스 추가
                 auto [x, y, z] = best_location;
+                unshared(main_bounds).add_placed(best_box_size);
                 main_placements.push_back(std::make_tuple(
                     x, y, z,
                     best_box_size[0] + stacking_interval,
@@ -437,13 +727,14 @@ private:
                     best_box_size[2] + stacking_interval
                 ));
 
-                final_placements.push_back({
+                record_result(final_placements, {
                     best_box_id,
                     std::make_tuple(x + std::ceil(best_box_size[0] / 2.0),
                                   y + std::ceil(best_box_size[1] / 2.0),
                                   z),
                     0,
-                    1
+                    1,
+                    2
                 });
 
                 return true;
@@ -454,19 +745,23 @@ private:
 
     std::vector<StackResult> stack_all_boxes()
     {
-        std::vector<std::tuple<int, int, int, int, int, int>> placements;
+        std::pmr::vector<std::tuple<int, int, int, int, int, int>> placements(&run_arena);
+        placements.reserve(box_ids.size());
         std::vector<StackResult> out_placements;
+        out_placements.reserve(box_ids.size());
 
         int pallet_width = pallet_size[0];
         int pallet_length = pallet_size[1];
         int pallet_height = pallet_size[2];
+        PalletBounds bounds(pallet_size, false);
 
-        for (const auto& box : boxes)
+        for (size_t i = 0; i < box_ids.size(); i++)
         {
-            std::vector<int> box_sizes = parseBoxSize(box.at("box_size"));
+            const std::string& box_id = box_ids[i];
+            const std::vector<int>& box_sizes = parsed_sizes[i];
             if (box_sizes.size() < 3)
             {
-                std::cerr << "Invalid box size for box ID: " << box.at("box_id") << std::endl;
+                std::cerr << "Invalid box size for box ID: " << box_id << std::endl;
                 continue;
             }
             int width = box_sizes[0];
@@ -474,6 +769,9 @@ private:
             int height = box_sizes[2];
             bool placed = false;
 
+            if (bounds.is_hopeless(box_sizes))
+                continue;
+
             for (int z = 0; z <= pallet_height - height; z += stacking_interval)
             {
                 if (placed) break;
@@ -496,8 +794,8 @@ private:
                             int b_x = x + std::ceil(width/2.0);
                             int b_y = y + std::ceil(length/2.0);
                             int b_z = z;
-                            out_placements.push_back({
-                                box.at("box_id"),
+                            record_result(out_placements, {
+                                box_id,
                                 std::make_tuple(b_x, b_y, b_z),
                                 0,
                                 1
@@ -526,18 +824,22 @@ private:
                         int b_x = std::ceil(width/2.0);
                         int b_y = std::ceil(length/2.0);
                         int b_z = z;
-                        out_placements.push_back({
-                            box.at("box_id"),
+                        record_result(out_placements, {
+                            box_id,
                             std::make_tuple(b_x, b_y, b_z),
                             0,
                             1
                         });
-
                         placed = true;
                         break;
                     }
                 }
             }
+
+            if (placed)
+                bounds.add_placed(box_sizes);
+            else
+                bounds.add_failed(box_sizes);
         }
         return out_placements;
     }
@@ -545,64 +847,35 @@ private:
     std::vector<StackResult> stack_buffer()
     {
         std::vector<StackResult> out_placements;
-        int pallet_width = pallet_size[0];
-        int pallet_length = pallet_size[1];
+        MaxRectsPacker packer(pallet_size[0] + stacking_interval, pallet_size[1] + stacking_interval, stacking_interval);
 
-        auto is_position_occupied = [&](int x, int y, int width, int length)
+        for (size_t i = 0; i < box_ids.size(); i++)
         {
-            for (const auto& p : buffer_placements)
-            {
-                int px = std::get<0>(p);
-                int py = std::get<1>(p);
-                int pwidth = std::get<3>(p);
-                int plength = std::get<4>(p);
-
-                if (!(x + width <= px || px + pwidth <= x || y + length <= py || py + plength <= y))
-                {
-                    return true;
-                }
-            }
-            return false;
-        };
-
-        for (const auto& box : boxes)
-        {
-            std::vector<int> box_sizes = parseBoxSize(box.at("box_size"));
+            const std::string& box_id = box_ids[i];
+            const std::vector<int>& box_sizes = parsed_sizes[i];
             if (box_sizes.size() < 3) continue;
 
             int width = box_sizes[0];
             int length = box_sizes[1];
-            bool placed = false;
             const int z = 0;
 
-            for (int y = 0; y <= pallet_length - length; y += stacking_interval)
-            {
-                if (placed)
-                    break;
-                
-                for (int x = 0; x <= pallet_width - width; x += stacking_interval)
-                {
-                    if (!is_position_occupied(x, y, width + stacking_interval, length + stacking_interval))
-                    {
-                        buffer_placements.push_back(std::make_tuple(
-                            x, y, z,
-                            width + stacking_interval,
-                            length + stacking_interval,
-                            box_sizes[2] + stacking_interval
-                        ));
-
-                        out_placements.push_back({
-                            box.at("box_id"),
-                            std::make_tuple(x + std::ceil(width/2.0), y + std::ceil(length/2.0), z),
-                            0,
-                            1
-                        });
+            PackedRect rect;
+            if (!packer.insert(width + stacking_interval, length + stacking_interval, false, rect))
+                continue;
 
-                        placed = true;
-                        break;
-                    }
-                }
-            }
+            buffer_placements.push_back(std::make_tuple(
+                rect.x, rect.y, z,
+                width + stacking_interval,
+                length + stacking_interval,
+                box_sizes[2] + stacking_interval
+            ));
+
+            record_result(out_placements, {
+                box_id,
+                std::make_tuple(rect.x + std::ceil(width/2.0), rect.y + std::ceil(length/2.0), z),
+                0,
+                1
+            });
         }
         return out_placements;
     }
@@ -610,22 +883,22 @@ private:
     std::vector<StackResult> stack_with_buffer()
     {
         // 먼저 버퍼 팔레트에 최대한 많이 배치
-        for (const auto& box : boxes)
+        for (size_t i = 0; i < box_ids.size(); i++)
         {
-            if (used_boxes.find(box.at("box_id")) != used_boxes.end())
+            if (used_boxes[i])
                 continue;
 
-            if (buffer_count < MAX_BUFFER_COUNT && try_place_in_buffer(box))
+            if (buffer_count < MAX_BUFFER_COUNT && try_place_in_buffer(i))
                 continue;
                 
-            try_place_in_main(box);
+            try_place_in_main(i);
         }
 
         // 버퍼에서 메인으로 이동 가능한 박스들 이동
         while (move_best_fit_from_buffer_to_main())
         {}
 
-        return final_placements;
+        return final_placements.to_vector();
     }
 
     std::vector<StackResult> optimized_stack()
@@ -633,30 +906,46 @@ private:
         std::vector<StackResult> results;
         
         // 부피 기준 정렬
-        std::vector<std::pair<std::string, std::vector<int>>> sorted_boxes;
-        for (const auto& box : boxes)
+        std::pmr::vector<size_t> sorted_boxes(&run_arena);
+        sorted_boxes.reserve(box_ids.size());
+        for (size_t i = 0; i < box_ids.size(); i++)
         {
-            auto size = parseBoxSize(box.at("box_size"));
-            sorted_boxes.push_back({box.at("box_id"), size});
+            if (parsed_sizes[i].size() >= 3)
+                sorted_boxes.push_back(i);
         }
         
         std::sort(sorted_boxes.begin(), sorted_boxes.end(),
-            [](const auto& a, const auto& b) {
-                auto vol_a = a.second[0] * a.second[1] * a.second[2];
-                auto vol_b = b.second[0] * b.second[1] * b.second[2];
+            [&](size_t a, size_t b) {
+                const auto& size_a = parsed_sizes[a];
+                const auto& size_b = parsed_sizes[b];
+                auto vol_a = size_a[0] * size_a[1] * size_a[2];
+                auto vol_b = size_b[0] * size_b[1] * size_b[2];
                 return vol_a > vol_b;
             });
 
         placement_manager = std::make_unique<BoxPlacement>(pallet_size);
+        // tryPlaceBox 의 90 도 탐색은 회전 전 치수로 범위를 정하므로 두 방향을 모두 다 본 것이 아니다.
+        // 뒤집힌 지배 관계로 가지치기하면 놓일 수 있는 박스가 빠지므로 회전 없는 경계를 쓴다
+        PalletBounds bounds(pallet_size, false);
         
-        for (const auto& [box_id, box_size] : sorted_boxes)
+        for (size_t box_index : sorted_boxes)
         {
+            const std::string& box_id = box_ids[box_index];
+            const std::vector<int>& box_size = parsed_sizes[box_index];
             std::tuple<int, int, int> position;
             int rotation;
+
+            if (bounds.is_hopeless(box_size))
+                continue;
             
-            if (tryPlaceBox(box_size, position, rotation))
+            if (!tryPlaceBox(box_size, position, rotation))
             {
-                results.push_back({
+                bounds.add_failed(box_size);
+            }
+            else
+            {
+                bounds.add_placed(box_size);
+                record_result(results, {
                     box_id,
                     std::make_tuple(
                         std::get<0>(position) + std::ceil(box_size[0]/2.0),
@@ -672,7 +961,236 @@ private:
         return results;
     }
 
+    // 결과의 메인 팔레트 적재 부피와 팔레트 수 하한(L1/L2), 최적성 갭
+    BoundsReport evaluate_bounds(const std::vector<StackResult>& results) const
+    {
+        std::vector<std::vector<int>> box_dims;
+        box_dims.reserve(parsed_sizes.size());
+        for (const auto& dims : parsed_sizes)
+        {
+            if (dims.size() >= 3)
+                box_dims.push_back(dims);
+        }
+
+        double placed_volume = 0;
+        for (const auto& result : results)
+        {
+            auto it = box_index_of.find(result.box_id);
+            if (result.pallet_id == 1 && it != box_index_of.end() && parsed_sizes[it->second].size() >= 3)
+            {
+                const auto& dims = parsed_sizes[it->second];
+                placed_volume += static_cast<double>(dims[0]) * dims[1] * dims[2];
+            }
+        }
+        return PalletBounds::report(box_dims, pallet_size, placed_volume, true);
+    }
+
+    std::vector<StackResult> stack_layered()
+    {
+        std::vector<StackResult> results;
+        results.reserve(box_ids.size());
+        const auto& box_dims = parsed_sizes;
+        std::pmr::vector<size_t> remaining(&run_arena);
+        remaining.reserve(box_ids.size());
+        for (size_t i = 0; i < box_ids.size(); i++)
+        {
+            if (box_dims[i].size() < 3)
+            {
+                std::cerr << "Invalid box size for box ID: " << box_ids[i] << std::endl;
+                continue;
+            }
+            remaining.push_back(i);
+        }
+
+        // 높이 내림차순, 같은 높이는 바닥 면적 내림차순
+        std::stable_sort(remaining.begin(), remaining.end(), [&](size_t a, size_t b) {
+            if (box_dims[a][2] != box_dims[b][2])
+                return box_dims[a][2] > box_dims[b][2];
+            return box_dims[a][0] * box_dims[a][1] > box_dims[b][0] * box_dims[b][1];
+        });
+
+        main_placements.clear();
+        PalletBounds bounds(pallet_size, false);
+        std::pmr::vector<size_t> leftovers(&run_arena);
+
+        auto record = [&](size_t idx, int x, int y, int z, int width, int length, int rotation) {
+            const auto& dims = box_dims[idx];
+            main_placements.push_back(std::make_tuple(
+                x, y, z,
+                width + stacking_interval,
+                length + stacking_interval,
+                dims[2] + stacking_interval
+            ));
+            record_result(results, {
+                box_ids[idx],
+                std::make_tuple(x + std::ceil(width / 2.0), y + std::ceil(length / 2.0), z),
+                rotation,
+                1
+            });
+            bounds.add_placed(dims);
+        };
+
+        // 층 단위 2D 적재: 가장 높은 박스가 층 높이를 정하고, 비슷한 높이의 박스들을 skyline 으로 채운다
+        int z = 0;
+        while (!remaining.empty())
+        {
+            auto tallest = std::find_if(remaining.begin(), remaining.end(),
+                [&](size_t idx) { return z + box_dims[idx][2] <= pallet_size[2]; });
+            if (tallest == remaining.end())
+                break;
+
+            int layer_height = box_dims[*tallest][2];
+            int min_height = static_cast<int>(std::ceil(layer_height * (1.0 - LAYER_HEIGHT_TOLERANCE)));
+            SkylinePacker packer(pallet_size[0] + stacking_interval, pallet_size[1] + stacking_interval);
+
+            std::pmr::vector<size_t> next_remaining(&run_arena);
+            next_remaining.reserve(remaining.size());
+            int placed_height = 0;
+            for (size_t idx : remaining)
+            {
+                const auto& dims = box_dims[idx];
+                PackedRect rect;
+                if (dims[2] <= layer_height && dims[2] >= min_height &&
+                    packer.insert(dims[0] + stacking_interval, dims[1] + stacking_interval, true, rect))
+                {
+                    record(idx, rect.x, rect.y, z,
+                           rect.width - stacking_interval, rect.length - stacking_interval,
+                           rect.rotated ? 90 : 0);
+                    placed_height = std::max(placed_height, dims[2]);
+                }
+                else
+                {
+                    next_remaining.push_back(idx);
+                }
+            }
+
+            if (placed_height == 0)
+            {
+                // 바닥면이 팔레트에 들어가지 않는 박스는 3D 적재로 넘긴다
+                leftovers.push_back(*tallest);
+                next_remaining.erase(std::find(next_remaining.begin(), next_remaining.end(), *tallest));
+            }
+            else
+            {
+                z += placed_height + stacking_interval;
+            }
+            remaining.swap(next_remaining);
+        }
+        leftovers.insert(leftovers.end(), remaining.begin(), remaining.end());
+
+        // 남은 박스는 층 사이 빈 공간에 3D 탐색으로 배치
+        for (size_t idx : leftovers)
+        {
+            const auto& dims = box_dims[idx];
+            if (bounds.is_hopeless(dims))
+                continue;
+
+            bool placed = false;
+            for (int bz = 0; bz <= pallet_size[2] - dims[2] && !placed; bz += stacking_interval)
+            {
+                for (int by = 0; by <= pallet_size[1] - dims[1] && !placed; by += stacking_interval)
+                {
+                    for (int bx = 0; bx <= pallet_size[0] - dims[0]; bx += stacking_interval)
+                    {
+                        if (!is_overlap(std::make_tuple(bx, by, bz, dims[0], dims[1], dims[2]), main_placements))
+                        {
+                            record(idx, bx, by, bz, dims[0], dims[1], 0);
+                            placed = true;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if (!placed)
+            {
+                bounds.add_failed(dims);
+            }
+        }
+
+        return results;
+    }
+
     std::vector<StackResult> Stack(StackingMethod stacking_method)
+    {
+        if (!setup_valid)
+        {
+            std::cerr << "Invalid stacking setup: pallet dimensions and box gap must be positive" << std::endl;
+            return {};
+        }
+
+        // 이전 실행의 임시 메모리를 한 번에 반환
+        run_arena.release();
+
+        if (!plan_cache)
+        {
+            return run_method(stacking_method);
+        }
+
+        for (const auto& dims : parsed_sizes)
+        {
+            if (dims.size() < 3)
+            {
+                return run_method(stacking_method);
+            }
+        }
+
+        // OPTIMIZED_STACK 과 LAYERED 는 입력 순서와 무관하게 박스를 정렬해서 배치한다
+        bool order_sensitive = stacking_method != StackingMethod::OPTIMIZED_STACK &&
+                               stacking_method != StackingMethod::LAYERED;
+        PlanKey key = PlanCache::make_key(parsed_sizes, pallet_size, stacking_interval,
+                                          static_cast<int>(stacking_method), order_sensitive);
+
+        std::vector<PlanEntry> entries;
+        if (!result_sink && plan_cache->lookup(key, entries))
+        {
+            std::vector<StackResult> results;
+            results.reserve(entries.size());
+            for (const auto& entry : entries)
+            {
+                record_result(results, {
+                    box_ids[key.order[entry.slot]],
+                    std::make_tuple(entry.x, entry.y, entry.z),
+                    entry.rot,
+                    entry.pallet_id,
+                    entry.from_pallet
+                });
+            }
+            return results;
+        }
+
+        auto results = run_method(stacking_method);
+
+        std::pmr::vector<uint32_t> slot_of(box_ids.size(), 0, &run_arena);
+        for (size_t slot = 0; slot < key.order.size(); slot++)
+        {
+            slot_of[key.order[slot]] = static_cast<uint32_t>(slot);
+        }
+        entries.clear();
+        entries.reserve(results.size());
+        for (const auto& result : results)
+        {
+            auto index_it = box_index_of.find(result.box_id);
+            if (index_it == box_index_of.end())
+            {
+                return results;
+            }
+            entries.push_back({
+                slot_of[index_it->second],
+                std::get<0>(result.box_loc),
+                std::get<1>(result.box_loc),
+                std::get<2>(result.box_loc),
+                result.box_rot,
+                static_cast<int16_t>(result.pallet_id),
+                static_cast<int16_t>(result.from_pallet)
+            });
+        }
+        plan_cache->store(key, entries);
+        return results;
+    }
+
+private:
+    std::vector<StackResult> run_method(StackingMethod stacking_method)
     {
         switch (stacking_method)
         {
@@ -686,10 +1204,12 @@ private:
                 return stack_with_buffer();
             case StackingMethod::OPTIMIZED_STACK:
                 return optimized_stack();
+            case StackingMethod::LAYERED:
+                return stack_layered();
             default:
                 throw std::invalid_argument("Invalid stacking method");
         }
     }
 };
 
-#endif
+#endif
\ No newline at end of file
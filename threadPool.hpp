@@ -0,0 +1,168 @@
+#ifndef _THREAD_POOL
+#define _THREAD_POOL
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <iostream>
+#include <exception>
+
+// Work-stealing thread pool.
+// worker 마다 deque 를 두고 자기 deque 는 뒤에서(LIFO), 다른 worker 의 deque 는 앞에서(FIFO) 가져간다.
+// 작업 크기가 제각각인 주문 묶음에서도 한 worker 에 작업이 몰리지 않는다
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency())
+    {
+        thread_count = std::max<size_t>(1, thread_count);
+        for (size_t i = 0; i < thread_count; i++)
+        {
+            queues.push_back(std::make_unique<WorkQueue>());
+        }
+        for (size_t i = 0; i < thread_count; i++)
+        {
+            workers.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            stopping = true;
+        }
+        work_available.notify_all();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // worker 안에서 호출하면 자기 deque 에, 밖에서 호출하면 돌아가며 나눠 넣는다
+    void submit(std::function<void()> task)
+    {
+        const WorkerIdentity& self = current_worker();
+        size_t target = self.pool == this
+            ? self.index
+            : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        {
+            // 계수를 먼저 올려야 다른 worker 가 꺼내 끝낸 뒤 pending 이 음수가 되는 일이 없다
+            std::lock_guard<std::mutex> lock(state_mutex);
+            pending++;
+            queued++;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queues[target]->mutex);
+            queues[target]->tasks.push_back(std::move(task));
+        }
+        work_available.notify_one();
+    }
+
+    // 제출된 작업이 모두 끝날 때까지 기다린다
+    void wait_idle()
+    {
+        std::unique_lock<std::mutex> lock(state_mutex);
+        all_done.wait(lock, [this] { return pending == 0; });
+    }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next_queue{0};
+
+    std::mutex state_mutex;
+    std::condition_variable work_available;
+    std::condition_variable all_done;
+    size_t pending = 0;      // 제출됐지만 아직 끝나지 않은 작업 수
+    size_t queued = 0;       // deque 에 들어 있는(아직 꺼내지 않은) 작업 수
+    bool stopping = false;
+
+    struct WorkerIdentity {
+        const ThreadPool* pool = nullptr;
+        size_t index = 0;
+    };
+
+    static WorkerIdentity& current_worker()
+    {
+        thread_local WorkerIdentity identity;
+        return identity;
+    }
+
+    bool pop_local(size_t index, std::function<void()>& task)
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        if (queues[index]->tasks.empty())
+            return false;
+        task = std::move(queues[index]->tasks.back());
+        queues[index]->tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t thief, std::function<void()>& task)
+    {
+        for (size_t offset = 1; offset < queues.size(); offset++)
+        {
+            size_t victim = (thief + offset) % queues.size();
+            std::lock_guard<std::mutex> lock(queues[victim]->mutex);
+            if (!queues[victim]->tasks.empty())
+            {
+                task = std::move(queues[victim]->tasks.front());
+                queues[victim]->tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void worker_loop(size_t index)
+    {
+        current_worker() = {this, index};
+        while (true)
+        {
+            std::function<void()> task;
+            if (pop_local(index, task) || steal(index, task))
+            {
+                {
+                    std::lock_guard<std::mutex> lock(state_mutex);
+                    queued--;
+                }
+                try {
+                    task();
+                } catch (const std::exception& e) {
+                    std::cerr << "Task failed: " << e.what() << std::endl;
+                }
+                std::lock_guard<std::mutex> lock(state_mutex);
+                if (--pending == 0)
+                {
+                    all_done.notify_all();
+                }
+                continue;
+            }
+
+            // 꺼낼 작업이 없으면 새 작업이 들어오거나 종료될 때까지 잠든다.
+            // 남은 작업은 종료 전에 모두 실행한다
+            std::unique_lock<std::mutex> lock(state_mutex);
+            work_available.wait(lock, [this] { return queued > 0 || stopping; });
+            if (stopping && queued == 0)
+                return;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,283 @@
+#ifndef _WORKLOAD_GENERATOR
+#define _WORKLOAD_GENERATOR
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <array>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <charconv>
+#include <thread>
+
+#include "boxRecord.hpp"
+#include "threadPool.hpp"
+
+// Counter-based random stream (SplitMix64 을 카운터에 적용).
+// (seed, stream) 이 같으면 어느 스레드에서 몇 번째로 만들든 같은 값이 나오므로
+// 박스/주문 단위로 stream 을 나누면 병렬 생성도 결정적이다
+class CounterRng {
+public:
+    CounterRng(uint64_t seed, uint64_t stream)
+        : key(mix(seed ^ mix(stream)))
+    {}
+
+    uint64_t next()
+    {
+        return mix(key + counter++ * GOLDEN);
+    }
+
+    // [0, 1)
+    double uniform()
+    {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    int uniform_int(int low, int high)
+    {
+        return low + static_cast<int>(uniform() * (static_cast<double>(high) - low + 1));
+    }
+
+    // Box-Muller. 짝으로 나오는 두 번째 값은 버려서 draw 수를 고정한다
+    double normal()
+    {
+        double u1 = 1.0 - uniform();
+        double u2 = uniform();
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * PI * u2);
+    }
+
+private:
+    // M_PI 는 표준이 아니라 MSVC 에서는 _USE_MATH_DEFINES 없이 정의되지 않는다
+    static constexpr double PI = 3.14159265358979323846;
+    static constexpr uint64_t GOLDEN = 0x9E3779B97F4A7C15ULL;
+    uint64_t key;
+    uint64_t counter = 0;
+
+    static uint64_t mix(uint64_t z)
+    {
+        z += GOLDEN;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+struct WorkloadConfig {
+    uint64_t seed = 1;
+    int id_offset = 0;                                   // 첫 박스 id
+    size_t sku_count = 1000;
+    double zipf_exponent = 1.1;                          // SKU 인기도 분포 (rank^-s)
+    std::array<double, 3> dim_median = {320, 260, 240};  // SKU 치수 lognormal 분포의 중앙값 (mm)
+    double dim_sigma = 0.35;
+    std::pair<int, int> dim_limits = {100, 700};
+    double density = 150.0;                              // 무게 계산용 평균 밀도 (kg/m^3)
+    double fragile_fraction = 0.05;                      // BOX_FLAG_FRAGILE 을 갖는 SKU 비율
+    std::pair<int, int> order_size = {20, 80};
+    double homogeneous_fraction = 0.3;                   // 한 SKU 로만 이루어진 주문 비율
+    size_t threads = std::thread::hardware_concurrency();
+};
+
+// SKU 카탈로그 기반 부하 생성기.
+// 카탈로그는 lognormal 치수의 SKU 로 만들고, 박스는 Zipf 인기도로 SKU 를 고른다.
+// 박스 i 는 stream (BOX, i), 주문 k 는 stream (ORDER, k) 만 쓰므로
+// 결과는 스레드 수와 관계없이 seed 로만 결정된다
+class WorkloadGenerator {
+public:
+    struct Sku {
+        std::array<int, 3> dims;
+        float weight;
+        uint32_t flags;
+    };
+
+    explicit WorkloadGenerator(const WorkloadConfig& config)
+        : config(config)
+    {
+        build_catalog();
+    }
+
+    const std::vector<Sku>& catalog() const { return skus; }
+
+    // SKU 를 Zipf 로 고른 박스 count 개. id 는 config.id_offset 부터 연속
+    std::vector<BoxRecord> generate_boxes(size_t count) const
+    {
+        std::vector<BoxRecord> records(count);
+        parallel_chunks(count, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                CounterRng rng(config.seed, stream_id(BOX_STREAM, i));
+                records[i] = make_record(config.id_offset + static_cast<int>(i), pick_sku(rng.uniform()));
+            }
+        });
+        return records;
+    }
+
+    // 주문 index 번. homogeneous_fraction 확률로 한 SKU 만 담고, 아니면 박스마다 SKU 를 고른다.
+    // 주문 안의 id 는 config.id_offset 부터 다시 시작한다
+    std::vector<BoxRecord> generate_order(size_t index) const
+    {
+        CounterRng rng(config.seed, stream_id(ORDER_STREAM, index));
+        int box_count = rng.uniform_int(config.order_size.first, config.order_size.second);
+        bool homogeneous = rng.uniform() < config.homogeneous_fraction;
+        size_t sku = pick_sku(rng.uniform());
+
+        std::vector<BoxRecord> records(box_count);
+        for (int i = 0; i < box_count; i++)
+        {
+            if (!homogeneous && i > 0)
+            {
+                sku = pick_sku(rng.uniform());
+            }
+            records[i] = make_record(config.id_offset + i, sku);
+        }
+        return records;
+    }
+
+    // 주문 order_count 개를 병렬로 만들어 하나씩 on_order(index, records) 로 넘긴다.
+    // on_order 는 여러 worker 에서 동시에 호출된다
+    template <typename OnOrder>
+    void generate_orders(size_t order_count, OnOrder on_order) const
+    {
+        parallel_chunks(order_count, [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; k++)
+            {
+                on_order(k, generate_order(k));
+            }
+        });
+    }
+
+    // 한 줄에 박스 하나: {"box_id":..,"box_size":[..],"weight":..,"flags":..}
+    static bool write_ndjson(const std::string& filename, const std::vector<BoxRecord>& records)
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "Can't open: " << filename << std::endl;
+            return false;
+        }
+
+        std::string buffer;
+        buffer.reserve((1 << 16) + 128);
+        char digits[32];
+        auto append_number = [&](auto value) {
+            auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+            buffer.append(digits, end);
+        };
+        for (const auto& record : records)
+        {
+            buffer.append("{\"box_id\":");
+            append_number(record.box_id);
+            buffer.append(",\"box_size\":[");
+            append_number(record.box_size[0]);
+            buffer.push_back(',');
+            append_number(record.box_size[1]);
+            buffer.push_back(',');
+            append_number(record.box_size[2]);
+            buffer.append("],\"weight\":");
+            append_number(static_cast<int>(std::lround(record.weight * 100.0f)) / 100.0);
+            buffer.append(",\"flags\":");
+            append_number(record.flags);
+            buffer.append("}\n");
+            if (buffer.size() >= (1 << 16))
+            {
+                file.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+        file.write(buffer.data(), buffer.size());
+        return static_cast<bool>(file);
+    }
+
+private:
+    static constexpr uint64_t SKU_STREAM = 1;
+    static constexpr uint64_t BOX_STREAM = 2;
+    static constexpr uint64_t ORDER_STREAM = 3;
+    static constexpr size_t CHUNK_SIZE = 1 << 15;
+
+    WorkloadConfig config;
+    std::vector<Sku> skus;
+    std::vector<double> popularity_cdf;
+
+    static uint64_t stream_id(uint64_t domain, uint64_t index)
+    {
+        return (domain << 56) ^ index;
+    }
+
+    void build_catalog()
+    {
+        size_t count = std::max<size_t>(1, config.sku_count);
+        skus.resize(count);
+        for (size_t j = 0; j < count; j++)
+        {
+            CounterRng rng(config.seed, stream_id(SKU_STREAM, j));
+            Sku& sku = skus[j];
+            for (int axis = 0; axis < 3; axis++)
+            {
+                double dim = config.dim_median[axis] * std::exp(config.dim_sigma * rng.normal());
+                sku.dims[axis] = std::clamp(static_cast<int>(std::lround(dim)),
+                                            config.dim_limits.first, config.dim_limits.second);
+            }
+            // 기존 생성기와 같이 긴 변을 x 로 둔다
+            if (sku.dims[0] < sku.dims[1])
+                std::swap(sku.dims[0], sku.dims[1]);
+
+            double volume_m3 = static_cast<double>(sku.dims[0]) * sku.dims[1] * sku.dims[2] * 1e-9;
+            sku.weight = static_cast<float>(volume_m3 * config.density * std::exp(0.25 * rng.normal()));
+            sku.flags = rng.uniform() < config.fragile_fraction ? static_cast<uint32_t>(BOX_FLAG_FRAGILE) : 0u;
+        }
+
+        // rank 1 이 가장 인기 있는 SKU
+        popularity_cdf.resize(count);
+        double total = 0.0;
+        for (size_t rank = 0; rank < count; rank++)
+        {
+            total += 1.0 / std::pow(static_cast<double>(rank + 1), config.zipf_exponent);
+            popularity_cdf[rank] = total;
+        }
+        for (auto& value : popularity_cdf)
+        {
+            value /= total;
+        }
+    }
+
+    size_t pick_sku(double u) const
+    {
+        auto it = std::upper_bound(popularity_cdf.begin(), popularity_cdf.end(), u);
+        return std::min(static_cast<size_t>(it - popularity_cdf.begin()), skus.size() - 1);
+    }
+
+    BoxRecord make_record(int box_id, size_t sku_index) const
+    {
+        const Sku& sku = skus[sku_index];
+        BoxRecord record;
+        record.box_id = box_id;
+        record.box_size = sku.dims;
+        record.weight = sku.weight;
+        record.flags = sku.flags;
+        return record;
+    }
+
+    // [0, count) 를 CHUNK_SIZE 단위로 나눠 pool 에서 실행한다. 작으면 호출한 스레드에서 바로 실행
+    template <typename Work>
+    void parallel_chunks(size_t count, Work work) const
+    {
+        size_t threads = std::max<size_t>(1, config.threads);
+        size_t chunk = std::min(CHUNK_SIZE, std::max<size_t>(1, (count + threads - 1) / threads));
+        if (threads == 1 || count <= chunk)
+        {
+            work(0, count);
+            return;
+        }
+
+        ThreadPool pool(threads);
+        for (size_t begin = 0; begin < count; begin += chunk)
+        {
+            size_t end = std::min(count, begin + chunk);
+            pool.submit([&work, begin, end] { work(begin, end); });
+        }
+        pool.wait_idle();
+    }
+};
+
+#endif
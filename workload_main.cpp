@@ -0,0 +1,184 @@
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <atomic>
+#include <exception>
+
+#include "stackingCore.hpp"
+#include "workloadGenerator.hpp"
+
+// 재현 가능한 부하 데이터 생성기
+//
+// usage: workload_main <output> [--boxes N | --orders N] [--seed S] [--format binary|ndjson]
+//                      [--skus N] [--zipf S] [--homogeneous F] [--order-size MIN MAX]
+//                      [--id-offset N] [--threads N]
+//
+// --boxes: output 파일 하나에 박스 N 개 (BoxSetFile 또는 NDJSON)
+// --orders: output 디렉토리에 주문 N 개와 batch_main 이 읽는 manifest.txt
+
+namespace {
+
+enum class WorkloadFormat {
+    BINARY,
+    NDJSON
+};
+
+struct WorkloadOptions {
+    std::filesystem::path output;
+    size_t box_count = 0;
+    size_t order_count = 0;
+    WorkloadFormat format = WorkloadFormat::BINARY;
+    WorkloadConfig config;
+};
+
+bool parse_args(int argc, char** argv, WorkloadOptions& options)
+{
+    if (argc < 2)
+        return false;
+    options.output = argv[1];
+
+    try {
+        for (int i = 2; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--boxes" && i + 1 < argc)
+            {
+                options.box_count = std::stoull(argv[++i]);
+            }
+            else if (arg == "--orders" && i + 1 < argc)
+            {
+                options.order_count = std::stoull(argv[++i]);
+            }
+            else if (arg == "--seed" && i + 1 < argc)
+            {
+                options.config.seed = std::stoull(argv[++i]);
+            }
+            else if (arg == "--format" && i + 1 < argc)
+            {
+                std::string name = argv[++i];
+                if (name == "binary") options.format = WorkloadFormat::BINARY;
+                else if (name == "ndjson") options.format = WorkloadFormat::NDJSON;
+                else return false;
+            }
+            else if (arg == "--skus" && i + 1 < argc)
+            {
+                options.config.sku_count = std::stoull(argv[++i]);
+            }
+            else if (arg == "--zipf" && i + 1 < argc)
+            {
+                options.config.zipf_exponent = std::stod(argv[++i]);
+            }
+            else if (arg == "--homogeneous" && i + 1 < argc)
+            {
+                options.config.homogeneous_fraction = std::stod(argv[++i]);
+            }
+            else if (arg == "--order-size" && i + 2 < argc)
+            {
+                options.config.order_size = {std::stoi(argv[i + 1]), std::stoi(argv[i + 2])};
+                i += 2;
+            }
+            else if (arg == "--id-offset" && i + 1 < argc)
+            {
+                options.config.id_offset = std::stoi(argv[++i]);
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                options.config.threads = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else
+            {
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid argument: " << e.what() << std::endl;
+        return false;
+    }
+    // 박스 묶음과 주문 묶음 중 하나만
+    return (options.box_count > 0) != (options.order_count > 0);
+}
+
+bool write_records(const std::filesystem::path& path, WorkloadFormat format, const std::vector<BoxRecord>& records)
+{
+    if (format == WorkloadFormat::NDJSON)
+        return WorkloadGenerator::write_ndjson(path.string(), records);
+    return BoxSetFile::write(path.string(), records);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    WorkloadOptions options;
+    if (!parse_args(argc, argv, options))
+    {
+        std::cerr << "usage: " << argv[0] << " <output> [--boxes N | --orders N] [--seed S] [--format binary|ndjson]\n"
+                  << "       [--skus N] [--zipf S] [--homogeneous F] [--order-size MIN MAX]\n"
+                  << "       [--id-offset N] [--threads N]" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    WorkloadGenerator generator(options.config);
+    size_t total_boxes = 0;
+    bool ok = true;
+
+    if (options.box_count > 0)
+    {
+        auto records = generator.generate_boxes(options.box_count);
+        total_boxes = records.size();
+        ok = write_records(options.output, options.format, records);
+    }
+    else
+    {
+        try {
+            std::filesystem::create_directories(options.output);
+        } catch (const std::filesystem::filesystem_error& e) {
+            std::cerr << "Error creating output directory: " << e.what() << std::endl;
+            return 1;
+        }
+
+        const char* extension = options.format == WorkloadFormat::NDJSON ? ".ndjson" : ".bin";
+        std::atomic<size_t> box_counter{0};
+        std::atomic<bool> all_written{true};
+        generator.generate_orders(options.order_count, [&](size_t index, const std::vector<BoxRecord>& records) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "order_%06zu%s", index, extension);
+            if (!write_records(options.output / name, options.format, records))
+            {
+                all_written = false;
+            }
+            box_counter += records.size();
+        });
+        total_boxes = box_counter;
+        ok = all_written;
+
+        std::ofstream manifest(options.output / "manifest.txt");
+        for (size_t index = 0; index < options.order_count; index++)
+        {
+            char name[32];
+            std::snprintf(name, sizeof(name), "order_%06zu%s", index, extension);
+            manifest << name << '\n';
+        }
+        ok = ok && static_cast<bool>(manifest);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "\nWorkload:" << std::endl;
+    std::cout << "--------------------" << std::endl;
+    std::cout << "Seed: " << options.config.seed << ", SKUs: " << generator.catalog().size() << std::endl;
+    if (options.order_count > 0)
+    {
+        std::cout << "Orders: " << options.order_count << std::endl;
+    }
+    std::cout << "Boxes: " << total_boxes << std::endl;
+    std::cout << "Elapsed: " << seconds << " s" << std::endl;
+    std::cout << "Output: " << options.output << std::endl;
+    std::cout << "--------------------" << std::endl;
+
+    return ok ? 0 : 1;
+}